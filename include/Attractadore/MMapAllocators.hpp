@@ -0,0 +1,499 @@
+#pragma once
+#include "TrivialVector.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+namespace Attractadore::TrivialVectorNameSpace {
+inline size_t page_size() noexcept {
+    static const size_t size = sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+constexpr size_t round_up(size_t size, size_t alignment) noexcept {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+inline void* map_anonymous(size_t size) {
+    auto p = mmap(
+        nullptr, size,
+        PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+        -1, 0);
+    if (p == MAP_FAILED) {
+        throw std::bad_alloc{};
+    }
+    return p;
+}
+
+// Prefaults [first, first + size) writable in one system call if the
+// kernel supports it
+inline void populate_pages(void* first, size_t size) noexcept {
+#ifdef MADV_POPULATE_WRITE
+    auto page = page_size();
+    auto addr = reinterpret_cast<uintptr_t>(first);
+    auto begin = addr / page * page;
+    auto end = addr + size;
+    if (not madvise(reinterpret_cast<void*>(begin), end - begin, MADV_POPULATE_WRITE)) {
+        return;
+    }
+#endif
+    touch_pages(first, size);
+}
+
+// Maps allocations of at least Threshold bytes on HugePageSize boundaries
+// and asks for transparent huge pages for them. Smaller allocations come
+// from malloc, so small vectors neither make a system call per regrowth
+// nor take up a page each.
+template<
+    typename T,
+    size_t HugePageSize = size_t(2) << 20,
+    size_t Threshold = HugePageSize
+> requires (
+    std::has_single_bit(HugePageSize) and
+    Threshold != 0 and Threshold % HugePageSize == 0)
+struct HugePageAllocator {
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    template<typename U>
+    struct rebind {
+        using other = HugePageAllocator<U, HugePageSize, Threshold>;
+    };
+
+    constexpr HugePageAllocator() noexcept = default;
+    template<typename U>
+    constexpr HugePageAllocator(
+        const HugePageAllocator<U, HugePageSize, Threshold>&
+    ) noexcept {}
+
+    [[nodiscard]] T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    [[nodiscard]] AllocationResult<T*> allocate_at_least(size_t n) {
+        if (not is_mapped(n)) {
+            auto [p, count] = Small().allocate_at_least(n);
+            // Keep the capacity below the threshold so that deallocate
+            // can tell malloc'd blocks from mappings
+            return {p, std::min(count, max_small_size())};
+        }
+        if (n > (std::numeric_limits<size_t>::max() - 2 * HugePageSize) / sizeof(T)) {
+            throw std::bad_array_new_length{};
+        }
+        auto size = mapping_size(n * sizeof(T));
+
+        // Over-allocate and trim to get a huge page aligned mapping
+        auto p = static_cast<char*>(map_anonymous(size + HugePageSize));
+        auto aligned = reinterpret_cast<char*>(
+            round_up(reinterpret_cast<uintptr_t>(p), HugePageSize));
+        auto head = aligned - p;
+        auto tail = HugePageSize - head;
+        if (head) {
+            munmap(p, head);
+        }
+        if (tail) {
+            munmap(aligned + size, tail);
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+        return {reinterpret_cast<T*>(aligned), size / sizeof(T)};
+    }
+
+    // Fresh anonymous mappings are always zero-filled
+    [[nodiscard]] AllocationResult<T*> allocate_zeroed_at_least(size_t n) {
+        if (is_mapped(n)) {
+            return allocate_at_least(n);
+        }
+        auto [p, count] = Small().allocate_zeroed_at_least(n);
+        return {p, std::min(count, max_small_size())};
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (is_mapped(n)) {
+            munmap(p, mapping_size(n * sizeof(T)));
+        } else {
+            Small().deallocate(p, n);
+        }
+    }
+
+    void populate(T* p, size_t n) noexcept {
+        populate_pages(p, n * sizeof(T));
+    }
+
+    friend constexpr bool operator==(
+        const HugePageAllocator&, const HugePageAllocator&
+    ) noexcept = default;
+
+private:
+    using Small = MallocAllocator<T>;
+
+    static constexpr size_t max_small_size() noexcept {
+        return (Threshold - 1) / sizeof(T);
+    }
+
+    static constexpr bool is_mapped(size_t n) noexcept {
+        return n > max_small_size();
+    }
+
+    // The mapping size is a function of the byte size that is stable under
+    // the capacity allocate_at_least reports, so deallocate unmaps exactly
+    // what was mapped
+    static size_t mapping_size(size_t bytes) noexcept {
+        return round_up(bytes, HugePageSize);
+    }
+};
+
+// Serves allocations below Threshold bytes from malloc and maps larger ones
+// directly. Growing a mapping goes through mremap, which moves pages instead
+// of copying them, so appending to a large vector costs O(pages) per
+// reallocation rather than O(size).
+template<typename T, size_t Threshold = size_t(128) << 10>
+    requires (Threshold >= sizeof(T))
+struct MMapAllocator {
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    template<typename U>
+    struct rebind {
+        using other = MMapAllocator<U, Threshold>;
+    };
+
+    constexpr MMapAllocator() noexcept = default;
+    template<typename U>
+    constexpr MMapAllocator(const MMapAllocator<U, Threshold>&) noexcept {}
+
+    [[nodiscard]] T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    [[nodiscard]] AllocationResult<T*> allocate_at_least(size_t n) {
+        return reallocate_at_least(nullptr, 0, n);
+    }
+
+    [[nodiscard]] AllocationResult<T*> allocate_zeroed_at_least(size_t n) {
+        if (is_mapped(n)) {
+            return allocate_at_least(n);
+        }
+        auto [p, count] = Small().allocate_zeroed_at_least(n);
+        return {p, std::min(count, max_small_size())};
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (is_mapped(n)) {
+            munmap(p, mapping_size(n));
+        } else {
+            Small().deallocate(p, n);
+        }
+    }
+
+    void populate(T* p, size_t n) noexcept {
+        populate_pages(p, n * sizeof(T));
+    }
+
+    [[nodiscard]] T* reallocate(T* p, size_t old_n, size_t new_n) {
+        return reallocate_at_least(p, old_n, new_n).ptr;
+    }
+
+    [[nodiscard]] AllocationResult<T*> reallocate_at_least(
+        T* p, size_t old_n, size_t new_n
+    ) {
+        if (new_n > (std::numeric_limits<size_t>::max() - page_size()) / sizeof(T)) {
+            throw std::bad_array_new_length{};
+        }
+
+        if (not is_mapped(new_n)) {
+            if (not is_mapped(old_n)) {
+                auto [new_p, count] = Small().reallocate_at_least(p, old_n, new_n);
+                // Keep the capacity below the threshold so that deallocate
+                // can tell malloc'd blocks from mappings
+                return {new_p, std::min(count, max_small_size())};
+            }
+            auto new_p = Small().allocate(new_n);
+            std::memcpy(new_p, p, new_n * sizeof(T));
+            deallocate(p, old_n);
+            return {new_p, new_n};
+        }
+
+        auto size = mapping_size(new_n);
+        if (is_mapped(old_n)) {
+            auto old_size = mapping_size(old_n);
+            if (size == old_size) {
+                return {p, size / sizeof(T)};
+            }
+#ifdef __linux__
+            auto new_p = mremap(p, old_size, size, MREMAP_MAYMOVE);
+            if (new_p == MAP_FAILED) {
+                throw std::bad_alloc{};
+            }
+            return {static_cast<T*>(new_p), size / sizeof(T)};
+#endif
+        }
+
+        auto new_p = static_cast<T*>(map_anonymous(size));
+        if (p) {
+            std::memcpy(new_p, p, std::min(old_n, new_n) * sizeof(T));
+            deallocate(p, old_n);
+        }
+        return {new_p, size / sizeof(T)};
+    }
+
+    friend constexpr bool operator==(
+        const MMapAllocator&, const MMapAllocator&
+    ) noexcept = default;
+
+private:
+    using Small = MallocAllocator<T>;
+
+    static constexpr size_t max_small_size() noexcept {
+        return (Threshold - 1) / sizeof(T);
+    }
+
+    static constexpr bool is_mapped(size_t n) noexcept {
+        return n > max_small_size();
+    }
+
+    static size_t mapping_size(size_t n) noexcept {
+        return round_up(n * sizeof(T), page_size());
+    }
+};
+
+// Reserves reserve_size bytes of address space per allocation up front and
+// commits pages as the capacity grows, so the buffer never moves and
+// pointers into it stay valid for as long as the vector lives. Growing
+// beyond the reservation throws std::bad_alloc instead of relocating.
+// Shrinking still moves the data to a new reservation.
+template<typename T>
+class VirtualReserveAllocator {
+    size_t m_reserve_size;
+
+public:
+    static constexpr size_t DefaultReserveSize = size_t(16) << 30;
+
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    constexpr explicit VirtualReserveAllocator(
+        size_t reserve_size = DefaultReserveSize
+    ) noexcept: m_reserve_size(reserve_size) {}
+
+    template<typename U>
+    constexpr VirtualReserveAllocator(
+        const VirtualReserveAllocator<U>& other
+    ) noexcept: m_reserve_size(other.reserve_size()) {}
+
+    constexpr size_t reserve_size() const noexcept {
+        return m_reserve_size;
+    }
+
+    [[nodiscard]] T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    [[nodiscard]] AllocationResult<T*> allocate_at_least(size_t n) {
+        if (n > m_reserve_size / sizeof(T)) {
+            throw std::bad_alloc{};
+        }
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+        flags |= MAP_NORESERVE;
+#endif
+        auto p = mmap(nullptr, m_reserve_size, PROT_NONE, flags, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc{};
+        }
+        auto size = commit_size(std::max<size_t>(n, 1));
+        if (mprotect(p, size, PROT_READ | PROT_WRITE)) {
+            munmap(p, m_reserve_size);
+            throw std::bad_alloc{};
+        }
+        return {static_cast<T*>(p), size / sizeof(T)};
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        munmap(p, m_reserve_size);
+    }
+
+    void populate(T* p, size_t n) noexcept {
+        populate_pages(p, n * sizeof(T));
+    }
+
+    size_t try_expand_at_least(T* p, size_t old_n, size_t new_n) {
+        if (new_n > m_reserve_size / sizeof(T)) {
+            throw std::bad_alloc{};
+        }
+        auto old_size = commit_size(old_n);
+        auto new_size = commit_size(new_n);
+        if (new_size > old_size) {
+            auto commit_begin = reinterpret_cast<char*>(p) + old_size;
+            auto commit = mprotect(
+                commit_begin, new_size - old_size, PROT_READ | PROT_WRITE);
+            if (commit) {
+                throw std::bad_alloc{};
+            }
+        }
+        return new_size / sizeof(T);
+    }
+
+    friend constexpr bool operator==(
+        const VirtualReserveAllocator& lhs, const VirtualReserveAllocator& rhs
+    ) noexcept {
+        return lhs.reserve_size() == rhs.reserve_size();
+    }
+
+private:
+    size_t commit_size(size_t n) const noexcept {
+        return std::min(round_up(n * sizeof(T), page_size()), m_reserve_size);
+    }
+};
+
+enum class NumaPolicy {
+    // Place all pages on the given nodes
+    Bind,
+    // Spread pages round-robin across the given nodes
+    Interleave,
+};
+
+// Maps every allocation and sets its NUMA policy before any page is faulted
+// in. nodes has bit i set for node i. Nodes that do not exist or that the
+// process may not use are ignored, so the default interleaves across all
+// available ones. Where the kernel does not support mbind pages get the
+// default first touch placement.
+template<typename T>
+class NumaAllocator {
+    uint64_t m_nodes;
+    NumaPolicy m_policy;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    constexpr explicit NumaAllocator(
+        NumaPolicy policy = NumaPolicy::Interleave,
+        uint64_t nodes = ~uint64_t(0)
+    ) noexcept: m_nodes(nodes), m_policy(policy) {}
+
+    template<typename U>
+    constexpr NumaAllocator(const NumaAllocator<U>& other) noexcept:
+        m_nodes(other.nodes()), m_policy(other.policy()) {}
+
+    static constexpr NumaAllocator on_node(unsigned node) noexcept {
+        assert(node < 64);
+        return NumaAllocator(NumaPolicy::Bind, uint64_t(1) << node);
+    }
+
+    constexpr uint64_t nodes() const noexcept {
+        return m_nodes;
+    }
+
+    constexpr NumaPolicy policy() const noexcept {
+        return m_policy;
+    }
+
+    [[nodiscard]] T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    [[nodiscard]] AllocationResult<T*> allocate_at_least(size_t n) {
+        if (n > (std::numeric_limits<size_t>::max() - page_size()) / sizeof(T)) {
+            throw std::bad_array_new_length{};
+        }
+        auto size = mapping_size(std::max<size_t>(n, 1));
+        auto p = map_anonymous(size);
+        bind(p, size);
+        return {static_cast<T*>(p), size / sizeof(T)};
+    }
+
+    // Fresh anonymous mappings are always zero-filled
+    [[nodiscard]] AllocationResult<T*> allocate_zeroed_at_least(size_t n) {
+        return allocate_at_least(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        munmap(p, mapping_size(std::max<size_t>(n, 1)));
+    }
+
+    void populate(T* p, size_t n) noexcept {
+        populate_pages(p, n * sizeof(T));
+    }
+
+#ifdef __linux__
+    // The policy moves with the mapping, the grown part is bound again
+    [[nodiscard]] T* reallocate(T* p, size_t old_n, size_t new_n) {
+        return reallocate_at_least(p, old_n, new_n).ptr;
+    }
+
+    [[nodiscard]] AllocationResult<T*> reallocate_at_least(
+        T* p, size_t old_n, size_t new_n
+    ) {
+        if (not p) {
+            return allocate_at_least(new_n);
+        }
+        if (new_n > (std::numeric_limits<size_t>::max() - page_size()) / sizeof(T)) {
+            throw std::bad_array_new_length{};
+        }
+        auto old_size = mapping_size(std::max<size_t>(old_n, 1));
+        auto size = mapping_size(std::max<size_t>(new_n, 1));
+        if (size == old_size) {
+            return {p, size / sizeof(T)};
+        }
+        auto new_p = mremap(p, old_size, size, MREMAP_MAYMOVE);
+        if (new_p == MAP_FAILED) {
+            throw std::bad_alloc{};
+        }
+        if (size > old_size) {
+            bind(static_cast<char*>(new_p) + old_size, size - old_size);
+        }
+        return {static_cast<T*>(new_p), size / sizeof(T)};
+    }
+#endif
+
+    friend constexpr bool operator==(
+        const NumaAllocator& lhs, const NumaAllocator& rhs
+    ) noexcept {
+        return lhs.nodes() == rhs.nodes() and lhs.policy() == rhs.policy();
+    }
+
+private:
+    static size_t mapping_size(size_t n) noexcept {
+        return round_up(n * sizeof(T), page_size());
+    }
+
+    // Failing to set the policy leaves the pages usable, only their
+    // placement is up to the kernel then
+    void bind(void* p, size_t size) const noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+        int mode = m_policy == NumaPolicy::Bind ? MPOL_BIND : MPOL_INTERLEAVE;
+        // The kernel reads maxnode - 1 bits of the mask
+        syscall(SYS_mbind, p, size, mode, &m_nodes, 8 * sizeof(m_nodes) + 1, 0);
+#endif
+    }
+};
+}
+
+namespace Attractadore {
+using TrivialVectorNameSpace::HugePageAllocator;
+using TrivialVectorNameSpace::MMapAllocator;
+using TrivialVectorNameSpace::NumaAllocator;
+using TrivialVectorNameSpace::NumaPolicy;
+using TrivialVectorNameSpace::VirtualReserveAllocator;
+template<
+    typename T,
+    typename GrowthPolicy = DoubleGrowth
+> using StableTrivialVector =
+    TrivialVector<T, VirtualReserveAllocator<T>, GrowthPolicy>;
+}
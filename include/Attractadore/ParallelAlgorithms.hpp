@@ -0,0 +1,247 @@
+#pragma once
+#include "TrivialVector.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace Attractadore::TrivialVectorNameSpace {
+inline constexpr size_t CacheLineSize = 64;
+
+// Each thread gets at least this many bytes to write, so that fills and
+// copies only go parallel once a single core's bandwidth is the limit
+inline constexpr size_t ParallelChunkSize = size_t(4) << 20;
+
+// Number of threads worth using for size bytes, at most max_threads or the
+// hardware concurrency if max_threads is 0. 1 means run serially.
+inline unsigned parallel_thread_count(
+    size_t size, unsigned max_threads = 0
+) noexcept {
+    if (not max_threads) {
+        max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    return std::clamp<size_t>(size / ParallelChunkSize, 1, max_threads);
+}
+
+// Start of the i-th of parts chunks of [first, first + count). Chunks start
+// on cache line boundaries where elements allow it, so that threads writing
+// neighboring chunks do not share lines. The split only depends on the
+// arguments, so code that later processes the same chunks on the same
+// threads touches memory the way the parallel fill did.
+template<typename T>
+size_t chunk_begin(
+    const T* first, size_t count, size_t parts, size_t i
+) noexcept {
+    if (i == 0) {
+        return 0;
+    }
+    if (i >= parts) {
+        return count;
+    }
+    auto base = reinterpret_cast<uintptr_t>(first);
+    auto split = base + count * sizeof(T) / parts * i;
+    split = std::max(split / CacheLineSize * CacheLineSize, base);
+    return std::min((split - base + sizeof(T) - 1) / sizeof(T), count);
+}
+
+// Calls fn(chunk_first, chunk_count) for threads cache line aligned chunks
+// of [first, first + count), chunk i on thread i, the first one on the
+// calling thread. fn must not throw. Chunks that no thread could be started
+// for are processed on the calling thread.
+template<typename T, typename Fn>
+    requires std::invocable<Fn&, T*, size_t>
+void for_each_chunk(T* first, size_t count, unsigned threads, Fn fn) {
+    if (threads <= 1) {
+        std::invoke(fn, first, count);
+        return;
+    }
+    auto run = [&] (size_t i) noexcept {
+        auto begin = chunk_begin(first, count, threads, i);
+        auto end = chunk_begin(first, count, threads, i + 1);
+        std::invoke(fn, first + begin, end - begin);
+    };
+    std::vector<std::jthread> workers;
+    unsigned started = 1;
+    try {
+        workers.reserve(threads - 1);
+        for (; started < threads; started++) {
+            workers.emplace_back(run, started);
+        }
+    } catch (const std::system_error&) {
+    } catch (const std::bad_alloc&) {}
+    run(0);
+    for (unsigned i = started; i < threads; i++) {
+        run(i);
+    }
+}
+
+template<typename T>
+void parallel_fill(
+    T* first, size_t count, const T& value, unsigned max_threads = 0
+) {
+    auto threads = parallel_thread_count(count * sizeof(T), max_threads);
+    for_each_chunk(first, count, threads, [&] (T* chunk, size_t n) {
+        std::fill_n(chunk, n, value);
+    });
+}
+
+template<typename T>
+void parallel_copy(
+    const T* src, size_t count, T* dst, unsigned max_threads = 0
+) {
+    auto threads = parallel_thread_count(count * sizeof(T), max_threads);
+    // Chunks follow the destination, which is what the threads write
+    for_each_chunk(dst, count, threads, [&] (T* chunk, size_t n) {
+        copy_elements(src + (chunk - dst), n, chunk);
+    });
+}
+
+// Parallel versions of the vector members of the same name. They behave
+// like the serial ones and split the writes across up to max_threads
+// threads, all hardware threads if 0.
+
+template<typename T, typename Allocator, typename GrowthPolicy, bool HasInlineStorage>
+void parallel_assign(
+    TrivialVectorHeader<T, Allocator, GrowthPolicy, HasInlineStorage>& vec,
+    size_t count, const std::type_identity_t<T>& value,
+    unsigned max_threads = 0
+) {
+    if (count > vec.max_size() or
+        parallel_thread_count(count * sizeof(T), max_threads) <= 1 or
+        (ZeroingAllocator<Allocator> and
+            count > vec.capacity() and is_zero_bits(value))
+    ) {
+        vec.assign(count, value);
+        return;
+    }
+    T fill_value = value;
+    vec.fit(count);
+    parallel_fill(vec.data(), count, fill_value, max_threads);
+}
+
+// Only contiguous ranges of T that do not overlap the vector's buffer are
+// copied in parallel. Chunks copied concurrently out of the same buffer
+// would read what another thread already overwrote.
+template<
+    typename T, typename Allocator, typename GrowthPolicy, bool HasInlineStorage,
+    std::ranges::input_range R
+> requires std::convertible_to<std::ranges::range_value_t<R>, T>
+void parallel_assign(
+    TrivialVectorHeader<T, Allocator, GrowthPolicy, HasInlineStorage>& vec,
+    R&& r, unsigned max_threads = 0
+) {
+    if constexpr (ContiguousRangeOf<R, T>) {
+        auto count = std::ranges::size(r);
+        auto src = reinterpret_cast<uintptr_t>(std::ranges::data(r));
+        auto buf = reinterpret_cast<uintptr_t>(vec.data());
+        auto overlaps =
+            src < buf + vec.capacity() * sizeof(T) and
+            buf < src + count * sizeof(T);
+        if (count <= vec.max_size() and not overlaps) {
+            vec.fit(count);
+            parallel_copy(std::ranges::data(r), count, vec.data(), max_threads);
+            return;
+        }
+    }
+    vec.assign(std::forward<R>(r));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy, bool HasInlineStorage>
+void parallel_resize(
+    TrivialVectorHeader<T, Allocator, GrowthPolicy, HasInlineStorage>& vec,
+    size_t new_size, const std::type_identity_t<T>& value,
+    unsigned max_threads = 0
+) {
+    auto old_size = vec.size();
+    if (new_size <= old_size or new_size > vec.max_size() or
+        parallel_thread_count(
+            (new_size - old_size) * sizeof(T), max_threads) <= 1
+    ) {
+        vec.resize(new_size, value);
+        return;
+    }
+    T fill_value = value;
+    vec.place_back(new_size - old_size);
+    parallel_fill(
+        vec.data() + old_size, new_size - old_size, fill_value, max_threads);
+}
+
+// First touch versions of reserve(n, populate) and fit(n). Unless the
+// allocator binds them, pages land on the NUMA node of the thread that
+// first writes them. These fault in the first n elements in the chunks
+// for_each_chunk(vec.data(), n, parallel_thread_count(n * sizeof(T),
+// max_threads)) hands out, chunk i on thread i, so threads that go on to
+// process the same chunks find them in local memory.
+
+template<
+    typename T, unsigned InlineCapacity, typename Allocator, typename GrowthPolicy
+> void parallel_reserve(
+    InlineTrivialVector<T, InlineCapacity, Allocator, GrowthPolicy>& vec,
+    size_t new_capacity, unsigned max_threads = 0
+) {
+    auto threads = parallel_thread_count(new_capacity * sizeof(T), max_threads);
+    if (new_capacity <= vec.capacity() or new_capacity > vec.max_size() or
+        threads <= 1
+    ) {
+        vec.reserve(new_capacity, populate);
+        return;
+    }
+    // The kept elements are copied into untouched memory by the threads
+    // that own it rather than reallocated by the calling thread
+    InlineTrivialVector<T, InlineCapacity, Allocator, GrowthPolicy> fresh(
+        vec.get_allocator());
+    fresh.reserve(new_capacity);
+    fresh.fit(vec.size());
+    size_t size = vec.size();
+    for_each_chunk(fresh.data(), new_capacity, threads, [&] (T* chunk, size_t n) {
+        size_t begin = chunk - fresh.data();
+        auto copy_end = std::clamp(size, begin, begin + n);
+        copy_elements(vec.data() + begin, copy_end - begin, chunk);
+        touch_pages(fresh.data() + copy_end, (begin + n - copy_end) * sizeof(T));
+    });
+    vec = std::move(fresh);
+}
+
+// Only a reallocated buffer is touched, a large enough one keeps its
+// contents and placement
+template<typename T, typename Allocator, typename GrowthPolicy, bool HasInlineStorage>
+void parallel_fit(
+    TrivialVectorHeader<T, Allocator, GrowthPolicy, HasInlineStorage>& vec,
+    size_t new_size, unsigned max_threads = 0
+) {
+    auto reallocate = new_size > vec.capacity();
+    vec.fit(new_size);
+    if (reallocate) {
+        auto threads = parallel_thread_count(new_size * sizeof(T), max_threads);
+        for_each_chunk(vec.data(), new_size, threads, [] (T* chunk, size_t n) {
+            touch_pages(chunk, n * sizeof(T));
+        });
+    }
+}
+
+// Like the copy constructor
+template<
+    typename T, unsigned InlineCapacity, typename Allocator, typename GrowthPolicy
+> InlineTrivialVector<T, InlineCapacity, Allocator, GrowthPolicy> parallel_copy(
+    const InlineTrivialVector<T, InlineCapacity, Allocator, GrowthPolicy>& vec,
+    unsigned max_threads = 0
+) {
+    using Traits = std::allocator_traits<Allocator>;
+    InlineTrivialVector<T, InlineCapacity, Allocator, GrowthPolicy> copy(
+        Traits::select_on_container_copy_construction(vec.get_allocator()));
+    copy.fit(vec.size());
+    parallel_copy(vec.data(), vec.size(), copy.data(), max_threads);
+    return copy;
+}
+}
+
+namespace Attractadore {
+using TrivialVectorNameSpace::ParallelChunkSize;
+using TrivialVectorNameSpace::for_each_chunk;
+using TrivialVectorNameSpace::parallel_assign;
+using TrivialVectorNameSpace::parallel_copy;
+using TrivialVectorNameSpace::parallel_fill;
+using TrivialVectorNameSpace::parallel_fit;
+using TrivialVectorNameSpace::parallel_reserve;
+using TrivialVectorNameSpace::parallel_resize;
+using TrivialVectorNameSpace::parallel_thread_count;
+}
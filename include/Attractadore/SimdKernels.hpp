@@ -0,0 +1,758 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ranges>
+#include <type_traits>
+
+// The kernels are picked at compile time from the target's instruction set.
+// Define TRIVIAL_VECTOR_NO_SIMD to always use the scalar code.
+#ifndef TRIVIAL_VECTOR_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRIVIAL_VECTOR_SSE2 1
+#endif
+#if defined(__AVX2__)
+#define TRIVIAL_VECTOR_AVX2 1
+#endif
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#define TRIVIAL_VECTOR_AVX512 1
+#endif
+#endif
+
+#ifdef TRIVIAL_VECTOR_SSE2
+#include <immintrin.h>
+#endif
+
+namespace Attractadore::TrivialVectorNameSpace {
+// Types for which the vector compare instructions implement ==: bitwise
+// equality for integers and IEEE equality for float and double
+template<typename T>
+concept SimdComparable =
+    (std::integral<T> and (
+        sizeof(T) == 1 or sizeof(T) == 2 or sizeof(T) == 4 or sizeof(T) == 8)) or
+    std::same_as<T, float> or std::same_as<T, double>;
+
+constexpr uint64_t low_bits(size_t count) noexcept {
+    return count < 64 ? (uint64_t(1) << count) - 1 : ~uint64_t(0);
+}
+
+// All masks below have one bit per element, the lowest for the element at
+// the lowest address
+#ifdef TRIVIAL_VECTOR_SSE2
+namespace Simd {
+#if defined(TRIVIAL_VECTOR_AVX512)
+inline constexpr size_t VectorSize = 64;
+
+template<SimdComparable T>
+inline uint64_t equal_mask(const T* p, T value) noexcept {
+    if constexpr (std::same_as<T, float>) {
+        return _mm512_cmp_ps_mask(
+            _mm512_loadu_ps(p), _mm512_set1_ps(value), _CMP_EQ_OQ);
+    } else if constexpr (std::same_as<T, double>) {
+        return _mm512_cmp_pd_mask(
+            _mm512_loadu_pd(p), _mm512_set1_pd(value), _CMP_EQ_OQ);
+    } else {
+        auto v = _mm512_loadu_si512(p);
+        if constexpr (sizeof(T) == 1) {
+            return _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(char(value)));
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm512_cmpeq_epi16_mask(v, _mm512_set1_epi16(short(value)));
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_cmpeq_epi32_mask(v, _mm512_set1_epi32(int(value)));
+        } else {
+            return _mm512_cmpeq_epi64_mask(v, _mm512_set1_epi64(int64_t(value)));
+        }
+    }
+}
+
+// Compares the first count < VectorSize / sizeof(T) elements at p. Masked
+// loads do not touch the memory past them.
+template<SimdComparable T>
+inline uint64_t equal_mask(const T* p, size_t count, T value) noexcept {
+    auto k = low_bits(count);
+    if constexpr (std::same_as<T, float>) {
+        return _mm512_mask_cmp_ps_mask(
+            __mmask16(k), _mm512_maskz_loadu_ps(__mmask16(k), p),
+            _mm512_set1_ps(value), _CMP_EQ_OQ);
+    } else if constexpr (std::same_as<T, double>) {
+        return _mm512_mask_cmp_pd_mask(
+            __mmask8(k), _mm512_maskz_loadu_pd(__mmask8(k), p),
+            _mm512_set1_pd(value), _CMP_EQ_OQ);
+    } else if constexpr (sizeof(T) == 1) {
+        return _mm512_mask_cmpeq_epi8_mask(
+            k, _mm512_maskz_loadu_epi8(k, p), _mm512_set1_epi8(char(value)));
+    } else if constexpr (sizeof(T) == 2) {
+        return _mm512_mask_cmpeq_epi16_mask(
+            __mmask32(k), _mm512_maskz_loadu_epi16(__mmask32(k), p),
+            _mm512_set1_epi16(short(value)));
+    } else if constexpr (sizeof(T) == 4) {
+        return _mm512_mask_cmpeq_epi32_mask(
+            __mmask16(k), _mm512_maskz_loadu_epi32(__mmask16(k), p),
+            _mm512_set1_epi32(int(value)));
+    } else {
+        return _mm512_mask_cmpeq_epi64_mask(
+            __mmask8(k), _mm512_maskz_loadu_epi64(__mmask8(k), p),
+            _mm512_set1_epi64(int64_t(value)));
+    }
+}
+
+// Byte and word compression need VBMI2
+template<typename T>
+inline constexpr bool HasCompress =
+#ifdef __AVX512VBMI2__
+    sizeof(T) == 1 or sizeof(T) == 2 or
+#endif
+    sizeof(T) == 4 or sizeof(T) == 8;
+
+// Packs the elements of the vector at src whose bit in keep is set to out,
+// which must not be past src. Stores a whole vector at out and returns the
+// end of the packed elements.
+template<typename T> requires HasCompress<T>
+inline T* compress(const T* src, uint64_t keep, T* out) noexcept {
+    auto v = _mm512_loadu_si512(src);
+    if constexpr (sizeof(T) == 1) {
+        v = _mm512_maskz_compress_epi8(keep, v);
+    } else if constexpr (sizeof(T) == 2) {
+        v = _mm512_maskz_compress_epi16(__mmask32(keep), v);
+    } else if constexpr (sizeof(T) == 4) {
+        v = _mm512_maskz_compress_epi32(__mmask16(keep), v);
+    } else {
+        v = _mm512_maskz_compress_epi64(__mmask8(keep), v);
+    }
+    _mm512_storeu_si512(out, v);
+    return out + std::popcount(keep);
+}
+
+// Same for the first count < VectorSize / sizeof(T) elements at src, with
+// masked loads and stores that touch no other memory
+template<typename T> requires HasCompress<T>
+inline T* compress(const T* src, size_t count, uint64_t keep, T* out) noexcept {
+    auto k = low_bits(count);
+    keep &= k;
+    auto n = std::popcount(keep);
+    auto s = low_bits(n);
+    if constexpr (sizeof(T) == 1) {
+        auto v = _mm512_maskz_loadu_epi8(k, src);
+        v = _mm512_maskz_compress_epi8(keep, v);
+        _mm512_mask_storeu_epi8(out, s, v);
+    } else if constexpr (sizeof(T) == 2) {
+        auto v = _mm512_maskz_loadu_epi16(__mmask32(k), src);
+        v = _mm512_maskz_compress_epi16(__mmask32(keep), v);
+        _mm512_mask_storeu_epi16(out, __mmask32(s), v);
+    } else if constexpr (sizeof(T) == 4) {
+        auto v = _mm512_maskz_loadu_epi32(__mmask16(k), src);
+        v = _mm512_maskz_compress_epi32(__mmask16(keep), v);
+        _mm512_mask_storeu_epi32(out, __mmask16(s), v);
+    } else {
+        auto v = _mm512_maskz_loadu_epi64(__mmask8(k), src);
+        v = _mm512_maskz_compress_epi64(__mmask8(keep), v);
+        _mm512_mask_storeu_epi64(out, __mmask8(s), v);
+    }
+    return out + n;
+}
+#elif defined(TRIVIAL_VECTOR_AVX2)
+inline constexpr size_t VectorSize = 32;
+
+template<SimdComparable T>
+inline uint64_t equal_mask(const T* p, T value) noexcept {
+    if constexpr (std::same_as<T, float>) {
+        return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(
+            _mm256_loadu_ps(p), _mm256_set1_ps(value), _CMP_EQ_OQ)));
+    } else if constexpr (std::same_as<T, double>) {
+        return uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(
+            _mm256_loadu_pd(p), _mm256_set1_pd(value), _CMP_EQ_OQ)));
+    } else {
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        if constexpr (sizeof(T) == 1) {
+            auto eq = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(char(value)));
+            return uint32_t(_mm256_movemask_epi8(eq));
+        } else if constexpr (sizeof(T) == 2) {
+            // Narrow the words to bytes, packing works within 128 bit lanes
+            auto eq = _mm256_cmpeq_epi16(v, _mm256_set1_epi16(short(value)));
+            eq = _mm256_permute4x64_epi64(
+                _mm256_packs_epi16(eq, eq), _MM_SHUFFLE(3, 1, 2, 0));
+            return uint16_t(_mm256_movemask_epi8(eq));
+        } else if constexpr (sizeof(T) == 4) {
+            auto eq = _mm256_cmpeq_epi32(v, _mm256_set1_epi32(int(value)));
+            return uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+        } else {
+            auto eq = _mm256_cmpeq_epi64(v, _mm256_set1_epi64x(int64_t(value)));
+            return uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(eq)));
+        }
+    }
+}
+
+// There is no compress instruction, so dwords and qwords are packed with a
+// permutation looked up by mask. Each entry holds the source lanes for one
+// mask of 8 dwords as nibbles.
+inline constexpr auto CompressTable = [] {
+    std::array<uint32_t, 256> table{};
+    for (unsigned mask = 0; mask < table.size(); mask++) {
+        unsigned count = 0;
+        for (unsigned lane = 0; lane < 8; lane++) {
+            if (mask >> lane & 1) {
+                table[mask] |= lane << (4 * count++);
+            }
+        }
+    }
+    return table;
+}();
+
+template<typename T>
+inline constexpr bool HasCompress = sizeof(T) == 4 or sizeof(T) == 8;
+
+// Packs the elements of the vector at src whose bit in keep is set to out,
+// which must not be past src. Stores a whole vector at out and returns the
+// end of the packed elements.
+template<typename T> requires HasCompress<T>
+inline T* compress(const T* src, uint64_t keep, T* out) noexcept {
+    unsigned lanes = keep;
+    if constexpr (sizeof(T) == 8) {
+        // Each qword is a pair of dwords
+        lanes =
+            (lanes & 1) * 0x03 | (lanes & 2) * 0x06 |
+            (lanes & 4) * 0x0c | (lanes & 8) * 0x18;
+    }
+    auto idx = _mm256_srlv_epi32(
+        _mm256_set1_epi32(int(CompressTable[lanes])),
+        _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28));
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    v = _mm256_permutevar8x32_epi32(v, idx);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+    return out + std::popcount(keep);
+}
+#else
+inline constexpr size_t VectorSize = 16;
+
+template<SimdComparable T>
+inline uint64_t equal_mask(const T* p, T value) noexcept {
+    if constexpr (std::same_as<T, float>) {
+        return uint32_t(_mm_movemask_ps(
+            _mm_cmpeq_ps(_mm_loadu_ps(p), _mm_set1_ps(value))));
+    } else if constexpr (std::same_as<T, double>) {
+        return uint32_t(_mm_movemask_pd(
+            _mm_cmpeq_pd(_mm_loadu_pd(p), _mm_set1_pd(value))));
+    } else {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        if constexpr (sizeof(T) == 1) {
+            auto eq = _mm_cmpeq_epi8(v, _mm_set1_epi8(char(value)));
+            return uint32_t(_mm_movemask_epi8(eq));
+        } else if constexpr (sizeof(T) == 2) {
+            auto eq = _mm_cmpeq_epi16(v, _mm_set1_epi16(short(value)));
+            return uint8_t(_mm_movemask_epi8(_mm_packs_epi16(eq, eq)));
+        } else if constexpr (sizeof(T) == 4) {
+            auto eq = _mm_cmpeq_epi32(v, _mm_set1_epi32(int(value)));
+            return uint32_t(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+        } else {
+            // SSE2 has no 64 bit compare, so both halves have to match
+            auto eq = _mm_cmpeq_epi32(v, _mm_set1_epi64x(int64_t(value)));
+            eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+            return uint32_t(_mm_movemask_pd(_mm_castsi128_pd(eq)));
+        }
+    }
+}
+
+template<typename T>
+inline constexpr bool HasCompress = false;
+#endif
+
+template<typename T>
+inline constexpr size_t Width = VectorSize / sizeof(T);
+
+template<SimdComparable T>
+inline size_t find(const T* data, size_t size, T value) noexcept {
+    constexpr auto W = Width<T>;
+    size_t i = 0;
+    for (; i + W <= size; i += W) {
+        if (auto mask = equal_mask(data + i, value)) {
+            return i + std::countr_zero(mask);
+        }
+    }
+    if (i == size) {
+        return size;
+    }
+#if defined(TRIVIAL_VECTOR_AVX512)
+    auto mask = equal_mask(data + i, size - i, value);
+    return mask ? i + std::countr_zero(mask) : size;
+#else
+    // Finish with a vector that overlaps the previous one, whose elements
+    // are known not to match
+    if (size >= W) {
+        auto mask = equal_mask(data + size - W, value);
+        return mask ? size - W + std::countr_zero(mask) : size;
+    }
+    return std::find(data + i, data + size, value) - data;
+#endif
+}
+
+template<SimdComparable T>
+inline size_t count(const T* data, size_t size, T value) noexcept {
+    constexpr auto W = Width<T>;
+    size_t cnt = 0;
+    size_t i = 0;
+    for (; i + W <= size; i += W) {
+        cnt += std::popcount(equal_mask(data + i, value));
+    }
+    if (i == size) {
+        return cnt;
+    }
+#if defined(TRIVIAL_VECTOR_AVX512)
+    cnt += std::popcount(equal_mask(data + i, size - i, value));
+#else
+    if (size >= W) {
+        // Drop the elements that the last full vector already counted
+        auto overlap = i + W - size;
+        cnt += std::popcount(equal_mask(data + size - W, value) >> overlap);
+    } else {
+        cnt += std::count(data, data + size, value);
+    }
+#endif
+    return cnt;
+}
+
+// Compares count <= 64 elements
+template<SimdComparable T>
+inline uint64_t equal_bits(const T* p, size_t count, T value) noexcept {
+    constexpr auto W = Width<T>;
+    uint64_t mask = 0;
+    size_t i = 0;
+    for (; i + W <= count; i += W) {
+        mask |= equal_mask(p + i, value) << i;
+    }
+#if defined(TRIVIAL_VECTOR_AVX512)
+    if (i != count) {
+        mask |= equal_mask(p + i, count - i, value) << i;
+    }
+#else
+    for (; i < count; i++) {
+        mask |= uint64_t(p[i] == value) << i;
+    }
+#endif
+    return mask;
+}
+
+template<typename T> requires HasCompress<T>
+inline T* compress_block(const T* src, size_t count, uint64_t keep, T* out) noexcept {
+    constexpr auto W = Width<T>;
+    size_t i = 0;
+    for (; i + W <= count; i += W) {
+        out = compress(src + i, keep >> i & low_bits(W), out);
+    }
+    if (i == count) {
+        return out;
+    }
+#if defined(TRIVIAL_VECTOR_AVX512)
+    return compress(src + i, count - i, keep >> i, out);
+#else
+    for (; i < count; i++) {
+        *out = src[i];
+        out += keep >> i & 1;
+    }
+    return out;
+#endif
+}
+
+// Returns the index of the first byte that differs, or size if there is
+// none
+inline size_t mismatch(
+    const unsigned char* lhs, const unsigned char* rhs, size_t size
+) noexcept {
+    size_t i = 0;
+#if defined(TRIVIAL_VECTOR_AVX512)
+    for (; i + 64 <= size; i += 64) {
+        auto ne = _mm512_cmpneq_epi8_mask(
+            _mm512_loadu_si512(lhs + i), _mm512_loadu_si512(rhs + i));
+        if (ne) {
+            return i + std::countr_zero(ne);
+        }
+    }
+    if (i != size) {
+        auto k = low_bits(size - i);
+        auto ne = _mm512_mask_cmpneq_epi8_mask(
+            k, _mm512_maskz_loadu_epi8(k, lhs + i),
+            _mm512_maskz_loadu_epi8(k, rhs + i));
+        return ne ? i + std::countr_zero(ne) : size;
+    }
+    return size;
+#else
+#if defined(TRIVIAL_VECTOR_AVX2)
+    for (; i + 32 <= size; i += 32) {
+        auto eq = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)))));
+        if (~eq) {
+            return i + std::countr_one(eq);
+        }
+    }
+#else
+    // Look at 64 bytes at a time until they differ
+    for (; i + 64 <= size; i += 64) {
+        auto load = [&] (const unsigned char* p, size_t off) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + off));
+        };
+        auto eq = _mm_and_si128(
+            _mm_and_si128(
+                _mm_cmpeq_epi8(load(lhs, 0), load(rhs, 0)),
+                _mm_cmpeq_epi8(load(lhs, 16), load(rhs, 16))),
+            _mm_and_si128(
+                _mm_cmpeq_epi8(load(lhs, 32), load(rhs, 32)),
+                _mm_cmpeq_epi8(load(lhs, 48), load(rhs, 48))));
+        if (_mm_movemask_epi8(eq) != 0xffff) {
+            break;
+        }
+    }
+#endif
+    for (; i + 16 <= size; i += 16) {
+        auto eq = uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i)))));
+        if (uint16_t(~eq)) {
+            return i + std::countr_one(eq);
+        }
+    }
+    while (i < size and lhs[i] == rhs[i]) {
+        i++;
+    }
+    return i;
+#endif
+}
+}
+#endif
+
+// Returns the index of the first element equal to value, or size if there
+// is none
+template<typename T>
+constexpr size_t find_index(const T* data, size_t size, const T& value) noexcept {
+#ifdef TRIVIAL_VECTOR_SSE2
+    if constexpr (SimdComparable<T>) {
+        if (not std::is_constant_evaluated()) {
+            return Simd::find(data, size, value);
+        }
+    }
+#endif
+    return std::find(data, data + size, value) - data;
+}
+
+template<typename T>
+constexpr size_t count_equal(const T* data, size_t size, const T& value) noexcept {
+#ifdef TRIVIAL_VECTOR_SSE2
+    if constexpr (SimdComparable<T>) {
+        if (not std::is_constant_evaluated()) {
+            return Simd::count(data, size, value);
+        }
+    }
+#endif
+    return std::count(data, data + size, value);
+}
+
+// Moves the elements of [src, src + count), count <= 64, whose bit in keep
+// is set to out, which must not be past src, and returns their new end.
+// Copies every element without branching on keep, or packs whole vectors
+// with compress instructions, so the cost does not depend on how
+// predictable keep is.
+template<typename T>
+constexpr T* compress_block(T* src, size_t count, uint64_t keep, T* out) noexcept {
+    keep &= low_bits(count);
+    if (out == src and keep == low_bits(count)) {
+        return src + count;
+    }
+#ifdef TRIVIAL_VECTOR_SSE2
+    if constexpr (Simd::HasCompress<T>) {
+        if (not std::is_constant_evaluated()) {
+            return Simd::compress_block(src, count, keep, out);
+        }
+    }
+#endif
+    for (size_t i = 0; i < count; i++) {
+        *out = src[i];
+        out += keep >> i & 1;
+    }
+    return out;
+}
+
+// Removes the elements equal to value and returns the new size
+template<typename T>
+constexpr size_t remove_equal(T* data, size_t size, const T& value) noexcept {
+#ifdef TRIVIAL_VECTOR_SSE2
+    if constexpr (SimdComparable<T>) {
+        if (not std::is_constant_evaluated()) {
+            auto out = data;
+            for (size_t i = 0; i < size; i += 64) {
+                auto count = std::min<size_t>(size - i, 64);
+                auto keep = ~Simd::equal_bits(data + i, count, value);
+                out = compress_block(data + i, count, keep, out);
+            }
+            return out - data;
+        }
+    }
+#endif
+    return std::remove(data, data + size, value) - data;
+}
+
+// Scalars whose == is equality of their bytes, which excludes floating
+// point. Class types may define == differently even if their bytes are
+// all significant.
+template<typename T>
+concept BitwiseComparable =
+    std::is_scalar_v<T> and std::has_unique_object_representations_v<T>;
+
+// Types whose <=> orders like memcmp
+template<typename T>
+concept BytewiseOrdered =
+    std::same_as<T, std::byte> or
+    (std::unsigned_integral<T> and sizeof(T) == 1);
+
+template<typename T>
+constexpr bool equal_elements(const T* lhs, const T* rhs, size_t size) noexcept {
+    if constexpr (BitwiseComparable<T>) {
+        if (not std::is_constant_evaluated()) {
+            return size == 0 or std::memcmp(lhs, rhs, size * sizeof(T)) == 0;
+        }
+    }
+    return std::equal(lhs, lhs + size, rhs);
+}
+
+// Lexicographic three way comparison. Unsigned bytes go through memcmp.
+// Wider integers look for the first differing byte and compare the
+// element that contains it.
+template<typename T>
+constexpr auto compare_elements(
+    const T* lhs, size_t lhs_size, const T* rhs, size_t rhs_size
+) noexcept {
+    if constexpr (BytewiseOrdered<T>) {
+        if (not std::is_constant_evaluated()) {
+            auto size = std::min(lhs_size, rhs_size);
+            if (int c = size ? std::memcmp(lhs, rhs, size) : 0) {
+                return c <=> 0;
+            }
+            return lhs_size <=> rhs_size;
+        }
+    }
+#ifdef TRIVIAL_VECTOR_SSE2
+    if constexpr (std::integral<T>) {
+        if (not std::is_constant_evaluated()) {
+            auto size = std::min(lhs_size, rhs_size);
+            auto idx = Simd::mismatch(
+                reinterpret_cast<const unsigned char*>(lhs),
+                reinterpret_cast<const unsigned char*>(rhs),
+                size * sizeof(T)) / sizeof(T);
+            if (idx != size) {
+                return lhs[idx] <=> rhs[idx];
+            }
+            return lhs_size <=> rhs_size;
+        }
+    }
+#endif
+    return std::lexicographical_compare_three_way(
+        lhs, lhs + lhs_size, rhs, rhs + rhs_size);
+}
+
+// Content hashing in the style of wyhash: 64 bit multiplies folded to 64
+// bits, with three independent lanes over long inputs so that the
+// multiplies overlap
+namespace Hash {
+inline constexpr uint64_t P0 = 0xa0761d6478bd642f;
+inline constexpr uint64_t P1 = 0xe7037ed1a0b428db;
+inline constexpr uint64_t P2 = 0x8ebc6af09c88c6e3;
+inline constexpr uint64_t P3 = 0x589965cc75374cc3;
+
+inline uint64_t mix(uint64_t a, uint64_t b) noexcept {
+#ifdef __SIZEOF_INT128__
+    auto r = static_cast<unsigned __int128>(a) * b;
+    return uint64_t(r) ^ uint64_t(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = uint32_t(a), lb = uint32_t(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t lo = t + (rm1 << 32);
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+    return lo ^ hi;
+#endif
+}
+
+inline uint64_t read8(const unsigned char* p) noexcept {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t read4(const unsigned char* p) noexcept {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t combine(uint64_t seed, uint64_t value) noexcept {
+    return mix(seed ^ P0, value ^ P1);
+}
+}
+
+inline uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0) noexcept {
+    using namespace Hash;
+    auto p = static_cast<const unsigned char*>(data);
+    seed ^= mix(seed ^ P0, P1);
+    uint64_t a, b;
+    if (size <= 16) {
+        if (size >= 4) {
+            // Two possibly overlapping pairs of dwords cover 4 to 16 bytes
+            auto off = (size >> 3) << 2;
+            a = read4(p) << 32 | read4(p + off);
+            b = read4(p + size - 4) << 32 | read4(p + size - 4 - off);
+        } else if (size > 0) {
+            a = uint64_t(p[0]) << 16 | uint64_t(p[size >> 1]) << 8 | p[size - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        auto left = size;
+        if (left > 48) {
+            auto seed1 = seed, seed2 = seed;
+            do {
+                seed = mix(read8(p) ^ P1, read8(p + 8) ^ seed);
+                seed1 = mix(read8(p + 16) ^ P2, read8(p + 24) ^ seed1);
+                seed2 = mix(read8(p + 32) ^ P3, read8(p + 40) ^ seed2);
+                p += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (left > 16) {
+            seed = mix(read8(p) ^ P1, read8(p + 8) ^ seed);
+            p += 16;
+            left -= 16;
+        }
+        a = read8(p + left - 16);
+        b = read8(p + left - 8);
+    }
+    return mix(P1 ^ size, mix(a ^ P1, b ^ seed));
+}
+
+// Hashes bitwise comparable elements as bytes and anything else by
+// combining std::hash of each element, which keeps equal vectors of
+// floating point or class types hashing equal
+template<typename T>
+concept ElementHashable =
+    BitwiseComparable<T> or
+    requires(const T& value) {
+        { std::hash<T>{}(value) } -> std::convertible_to<size_t>;
+    };
+
+template<ElementHashable T>
+size_t hash_elements(const T* data, size_t size) noexcept {
+    if constexpr (BitwiseComparable<T>) {
+        return hash_bytes(data, size * sizeof(T));
+    } else {
+        uint64_t h = hash_bytes(nullptr, 0, size);
+        for (size_t i = 0; i < size; i++) {
+            h = Hash::combine(h, std::hash<T>{}(data[i]));
+        }
+        return h;
+    }
+}
+
+// Writes of at least this many bytes go through non-temporal stores when
+// streaming is requested. Below it the data likely fits in the last level
+// cache anyway and normal stores are cheaper.
+inline constexpr size_t StreamThreshold = size_t(1) << 20;
+
+#ifdef TRIVIAL_VECTOR_SSE2
+namespace Simd {
+// Streams whole cache lines from the first 16 byte boundary in dst on and
+// leaves the unaligned head and tail to memcpy. The fence orders the
+// weakly ordered stores before anything that follows.
+inline void stream_copy(void* dst, const void* src, size_t size) noexcept {
+    auto d = static_cast<unsigned char*>(dst);
+    auto s = static_cast<const unsigned char*>(src);
+    auto head = std::min(size, (16 - reinterpret_cast<uintptr_t>(d) % 16) % 16);
+    std::memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+    for (; size >= 64; size -= 64, d += 64, s += 64) {
+        for (size_t i = 0; i < 64; i += 16) {
+            _mm_stream_si128(
+                reinterpret_cast<__m128i*>(d + i),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)));
+        }
+    }
+    _mm_sfence();
+    std::memcpy(d, s, size);
+}
+
+// The elements repeat every 16 bytes, so once the first ones are written
+// the 16 bytes at the first aligned address hold the pattern to stream
+template<typename T> requires (16 % sizeof(T) == 0)
+inline void stream_fill(T* dst, size_t count, const T& value) noexcept {
+    auto d = reinterpret_cast<unsigned char*>(dst);
+    auto end = d + count * sizeof(T);
+    auto aligned = d + (16 - reinterpret_cast<uintptr_t>(d) % 16) % 16;
+    auto head = (aligned + 16 - d + sizeof(T) - 1) / sizeof(T);
+    std::fill_n(dst, head, value);
+    auto pattern = _mm_load_si128(reinterpret_cast<const __m128i*>(aligned));
+    auto p = aligned + 16;
+    for (; end - p >= 64; p += 64) {
+        for (size_t i = 0; i < 64; i += 16) {
+            _mm_stream_si128(reinterpret_cast<__m128i*>(p + i), pattern);
+        }
+    }
+    _mm_sfence();
+    // p is a multiple of 16 bytes past aligned and so at an element
+    // boundary in the pattern, but not necessarily at one in dst
+    for (; p < end; p += 16) {
+        std::memcpy(p, &pattern, std::min<size_t>(end - p, 16));
+    }
+}
+}
+#endif
+
+// Ranges whose elements can be copied out as one block of bytes
+template<typename R, typename T>
+concept ContiguousRangeOf =
+    std::ranges::contiguous_range<R> and std::ranges::sized_range<R> and
+    std::same_as<std::remove_cv_t<std::ranges::range_value_t<R>>, T>;
+
+// Copies count elements and uses non-temporal stores for large copies
+template<typename T>
+constexpr void stream_copy(const T* src, size_t count, T* dst) noexcept {
+    if (std::is_constant_evaluated()) {
+        std::copy_n(src, count, dst);
+        return;
+    }
+    auto size = count * sizeof(T);
+#ifdef TRIVIAL_VECTOR_SSE2
+    auto s = reinterpret_cast<uintptr_t>(src);
+    auto d = reinterpret_cast<uintptr_t>(dst);
+    if (size >= StreamThreshold and (d + size <= s or s + size <= d)) {
+        Simd::stream_copy(dst, src, size);
+        return;
+    }
+#endif
+    if (size) {
+        std::memmove(dst, src, size);
+    }
+}
+
+// Fills count elements and uses non-temporal stores for large fills of
+// elements whose size divides 16 bytes
+template<typename T>
+constexpr void stream_fill(T* dst, size_t count, const T& value) noexcept {
+#ifdef TRIVIAL_VECTOR_SSE2
+    if constexpr (16 % sizeof(T) == 0) {
+        if (not std::is_constant_evaluated() and
+            count * sizeof(T) >= StreamThreshold
+        ) {
+            Simd::stream_fill(dst, count, value);
+            return;
+        }
+    }
+#endif
+    std::fill_n(dst, count, value);
+}
+}
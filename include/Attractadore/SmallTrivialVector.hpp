@@ -0,0 +1,831 @@
+#pragma once
+#include "TrivialVector.hpp"
+
+#include <cstring>
+
+namespace Attractadore::TrivialVectorNameSpace {
+// A vector laid out like a short string. While the data fits, the elements
+// are stored over the pointer, size and capacity fields and the size goes
+// into the last byte, so SmallTrivialVector<char> holds 23 elements inline
+// in 24 bytes. Once it spills to the heap, the last byte is the top of the
+// capacity field, whose highest bit is set as a flag.
+template<
+    typename T,
+    typename Allocator = std::allocator<T>,
+    typename GrowthPolicy = DoubleGrowth
+> requires (
+    TrivialVectorHeaderConcept<T, Allocator, GrowthPolicy> and
+    std::is_trivially_copyable_v<T> and
+    std::is_trivially_copyable_v<
+        typename std::allocator_traits<Allocator>::pointer> and
+    allocator_alignment<Allocator> <=
+        alignof(typename std::allocator_traits<Allocator>::pointer))
+class SmallTrivialVector: private Allocator {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Ptr = AllocTraits::pointer;
+    using SizeType = AllocTraits::size_type;
+
+    static constexpr size_t DataOffset      = 0;
+    static constexpr size_t SizeOffset      = DataOffset + sizeof(Ptr);
+    static constexpr size_t CapacityOffset  = SizeOffset + sizeof(SizeType);
+    static constexpr size_t RepSize         = CapacityOffset + sizeof(SizeType);
+
+    // The last byte is the most significant byte of the capacity on little
+    // endian targets and the least significant one on big endian ones
+    static constexpr bool LittleEndian = std::endian::native == std::endian::little;
+    static constexpr unsigned TagShift =
+        LittleEndian ? std::numeric_limits<SizeType>::digits - 8 : 0;
+    static constexpr unsigned CapacityShift = LittleEndian ? 0 : 8;
+    static constexpr SizeType TagMask = SizeType(0xff) << TagShift;
+    static constexpr unsigned char HeapFlag = 0x80;
+
+    // Like vectors without inline storage, ones whose elements don't fit
+    // into the representation never test the flag, and are empty with a
+    // null heap buffer
+    static constexpr size_t InlineCapacity = (RepSize - 1) / sizeof(T);
+    static constexpr bool HasInlineStorage = InlineCapacity != 0;
+
+    alignas(Ptr) std::byte m_rep[RepSize];
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using growth_policy = GrowthPolicy;
+    using size_type = SizeType;
+    using difference_type = ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = VectorIterator<pointer>;
+    using const_iterator = VectorIterator<const_pointer>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_t alignment = allocator_alignment<Allocator>;
+
+    SmallTrivialVector() noexcept(
+        std::is_nothrow_default_constructible_v<Allocator>
+    ) requires std::default_initializable<Allocator>:
+        SmallTrivialVector(Allocator()) {}
+
+    explicit SmallTrivialVector(Allocator alloc) noexcept:
+        Allocator(std::move(alloc))
+    {
+        set_empty();
+    }
+
+    explicit SmallTrivialVector(size_type size)
+        requires std::default_initializable<Allocator> and
+            std::default_initializable<value_type>:
+        SmallTrivialVector(size, Allocator()) {}
+
+    SmallTrivialVector(size_type size, Allocator alloc)
+        requires std::default_initializable<value_type>:
+        SmallTrivialVector(std::move(alloc))
+    {
+        resize(size);
+    }
+
+    SmallTrivialVector(size_type count, const value_type& value)
+        requires std::default_initializable<Allocator>:
+        SmallTrivialVector(count, value, Allocator()) {}
+
+    SmallTrivialVector(size_type count, const value_type& value, Allocator alloc):
+        SmallTrivialVector(std::move(alloc))
+    {
+        assign(count, value);
+    }
+
+    template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
+        requires std::convertible_to<std::iter_value_t<Iter>, value_type>
+    SmallTrivialVector(Iter first, Sent last)
+        requires std::default_initializable<Allocator>:
+        SmallTrivialVector(first, last, Allocator()) {}
+
+    template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
+        requires std::convertible_to<std::iter_value_t<Iter>, value_type>
+    SmallTrivialVector(Iter first, Sent last, Allocator alloc):
+        SmallTrivialVector(std::move(alloc))
+    {
+        assign(first, last);
+    }
+
+    template<std::ranges::input_range R>
+        requires std::convertible_to<std::ranges::range_value_t<R>, value_type>
+    explicit SmallTrivialVector(R&& r)
+        requires std::default_initializable<Allocator>:
+        SmallTrivialVector(std::forward<R>(r), Allocator()) {}
+
+    template<std::ranges::input_range R>
+        requires std::convertible_to<std::ranges::range_value_t<R>, value_type>
+    SmallTrivialVector(R&& r, Allocator alloc):
+        SmallTrivialVector(std::move(alloc))
+    {
+        assign(std::forward<R>(r));
+    }
+
+    SmallTrivialVector(std::initializer_list<value_type> init)
+        requires std::default_initializable<Allocator>:
+        SmallTrivialVector(init.begin(), init.end()) {}
+
+    SmallTrivialVector(const SmallTrivialVector& other):
+        SmallTrivialVector(
+            AllocTraits::select_on_container_copy_construction(
+                other.get_allocator()))
+    {
+        assign(other);
+    }
+
+    // The representation holds no pointer into itself, so moving it is a
+    // plain copy of its bytes
+    SmallTrivialVector(SmallTrivialVector&& other) noexcept:
+        Allocator(std::move(other.allocator()))
+    {
+        std::memcpy(m_rep, other.m_rep, RepSize);
+        other.set_empty();
+    }
+
+    ~SmallTrivialVector() {
+        deallocate();
+    }
+
+    SmallTrivialVector& operator=(const SmallTrivialVector& other) {
+        if (this == &other) {
+            return *this;
+        }
+        constexpr bool propagate =
+            AllocTraits::propagate_on_container_copy_assignment::value;
+        if constexpr (propagate) {
+            if (not allocators_equal(*this, other)) {
+                deallocate();
+                set_empty();
+                allocator() = other.get_allocator();
+            }
+        }
+        assign(other);
+        return *this;
+    }
+
+    SmallTrivialVector& operator=(SmallTrivialVector&& other) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value or
+        AllocTraits::is_always_equal::value
+    ) {
+        if (this == &other) {
+            return *this;
+        }
+        constexpr bool propagate =
+            AllocTraits::propagate_on_container_move_assignment::value;
+        if (propagate or allocators_equal(*this, other)) {
+            deallocate();
+            if constexpr (propagate) {
+                allocator() = std::move(other.allocator());
+            }
+            std::memcpy(m_rep, other.m_rep, RepSize);
+            other.set_empty();
+        } else {
+            assign(other);
+            other.clear();
+        }
+        return *this;
+    }
+
+    SmallTrivialVector& operator=(std::initializer_list<value_type> init) {
+        assign(init);
+        return *this;
+    }
+
+    void assign(size_type count, const value_type& value) {
+        auto fill_value = value;
+        fit(count);
+        std::ranges::fill(*this, fill_value);
+    }
+
+    template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
+        requires std::convertible_to<std::iter_value_t<Iter>, value_type>
+    void assign(Iter first, Sent last) {
+        if constexpr (std::sized_sentinel_for<Sent, Iter>) {
+            auto new_size = std::ranges::distance(first, last);
+            length_check(0, new_size);
+            if (size_type(new_size) > capacity()) {
+                // The range may point into this vector
+                reallocate(new_size, [&] (auto, auto new_data) {
+                    copy_range(first, last, new_data);
+                });
+                set_size(new_size);
+            } else {
+                copy_range(first, last, data());
+                set_size(new_size);
+            }
+        } else {
+            clear();
+            append(first, last);
+        }
+    }
+
+    template<std::ranges::input_range R>
+        requires std::convertible_to<std::ranges::range_value_t<R>, value_type>
+    void assign(R&& r) {
+        assign(std::ranges::begin(r), std::ranges::end(r));
+    }
+
+    void assign(std::initializer_list<value_type> init) {
+        assign(init.begin(), init.end());
+    }
+
+    const allocator_type& get_allocator() const noexcept { return *this; }
+
+    const_reference at(size_type idx) const {
+        range_check(idx);
+        return data()[idx];
+    }
+
+    reference at(size_type idx) {
+        range_check(idx);
+        return data()[idx];
+    }
+
+    const_reference operator[](size_type idx) const noexcept {
+        assert(idx < size());
+        return data()[idx];
+    }
+
+    reference operator[](size_type idx) noexcept {
+        assert(idx < size());
+        return data()[idx];
+    }
+
+    const_reference front() const noexcept {
+        assert(not empty());
+        return data()[0];
+    }
+
+    reference front() noexcept {
+        assert(not empty());
+        return data()[0];
+    }
+
+    const_reference back() const noexcept {
+        assert(not empty());
+        return data()[size() - 1];
+    }
+
+    reference back() noexcept {
+        assert(not empty());
+        return data()[size() - 1];
+    }
+
+    const value_type* cdata() const noexcept {
+        return data();
+    }
+
+    const value_type* data() const noexcept {
+        if (data_is_inlined()) {
+            return inline_data();
+        }
+        return std::to_address(heap_data());
+    }
+
+    value_type* data() noexcept {
+        if (data_is_inlined()) {
+            return inline_data();
+        }
+        return std::to_address(heap_data());
+    }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    const_iterator begin() const noexcept { return const_iterator{data()}; }
+    const_iterator end() const noexcept { return const_iterator{data() + size()}; }
+    iterator begin() noexcept { return iterator{data()}; }
+    iterator end() noexcept { return iterator{data() + size()}; }
+
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+    reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+    reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    size_type size() const noexcept {
+        if (data_is_inlined()) {
+            return std::to_integer<size_type>(m_rep[RepSize - 1]);
+        }
+        return load<SizeType>(SizeOffset);
+    }
+
+    size_type size_bytes() const noexcept {
+        return size() * sizeof(value_type);
+    }
+
+    // The capacity field gives up its top byte to the flag
+    static constexpr size_type max_size() noexcept {
+        return std::min<size_type>(
+            std::numeric_limits<size_type>::max() >> 8,
+            std::numeric_limits<size_type>::max() / sizeof(value_type));
+    }
+
+    static constexpr size_type max_inline_size() noexcept {
+        return InlineCapacity;
+    }
+
+    std::span<const std::byte> as_bytes() const noexcept {
+        return std::span{
+            reinterpret_cast<const std::byte*>(data()), size_bytes()};
+    }
+
+    std::span<std::byte> as_bytes() noexcept {
+        return std::span{
+            reinterpret_cast<std::byte*>(data()), size_bytes()};
+    }
+
+    static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+    const_iterator find(const value_type& value) const noexcept {
+        return begin() + find_index(data(), size(), value);
+    }
+
+    iterator find(const value_type& value) noexcept {
+        return begin() + find_index(data(), size(), value);
+    }
+
+    bool contains(const value_type& value) const noexcept {
+        return find_index(data(), size(), value) != size();
+    }
+
+    size_type index_of(const value_type& value) const noexcept {
+        auto idx = find_index(data(), size(), value);
+        return idx != size() ? idx : npos;
+    }
+
+    size_type count(const value_type& value) const noexcept {
+        return count_equal(data(), size(), value);
+    }
+
+    size_t hash() const noexcept requires ElementHashable<T> {
+        return hash_elements(data(), size());
+    }
+
+    size_type capacity() const noexcept {
+        if (data_is_inlined()) {
+            return max_inline_size();
+        }
+        return (load<SizeType>(CapacityOffset) & ~TagMask) >> CapacityShift;
+    }
+
+    bool data_is_inlined() const noexcept {
+        if constexpr (HasInlineStorage) {
+            return not (std::to_integer<unsigned char>(m_rep[RepSize - 1]) & HeapFlag);
+        } else {
+            return false;
+        }
+    }
+
+    size_type reserve(size_type new_capacity) {
+        if (new_capacity > capacity()) {
+            length_check(0, new_capacity);
+            reallocate(new_capacity, ReallocateWithCopy{size()});
+        }
+        return capacity();
+    }
+
+    size_type reserve_more(size_type additional_capacity) {
+        length_check(size(), additional_capacity);
+        return reserve(size() + additional_capacity);
+    }
+
+    void clear() noexcept {
+        truncate(0);
+    }
+
+    void truncate(size_type new_size) noexcept {
+        assert(new_size <= size());
+        set_size(new_size);
+    }
+
+    // New elements are default-initialized, which leaves them
+    // uninitialized for trivially default constructible types
+    void resize(size_type new_size)
+        requires std::default_initializable<value_type>
+    {
+        auto old_size = size();
+        resize_uninitialized(new_size);
+        if constexpr (not std::is_trivially_default_constructible_v<value_type>) {
+            if (new_size > old_size) {
+                std::ranges::uninitialized_default_construct(
+                    data() + old_size, data() + new_size);
+            }
+        }
+    }
+
+    void resize(size_type new_size, const value_type& value) {
+        auto old_size = size();
+        auto fill_value = value;
+        resize_uninitialized(new_size);
+        if (new_size > old_size) {
+            std::ranges::fill(data() + old_size, data() + new_size, fill_value);
+        }
+    }
+
+    void fit(size_type new_size) {
+        if (new_size > capacity()) {
+            grow(new_size, ReallocateWithCopy{0});
+        }
+        set_size(new_size);
+    }
+
+    template<typename... Args>
+        requires std::constructible_from<value_type, Args&&...>
+    reference emplace_back(Args&&... args) {
+        value_type value(std::forward<Args>(args)...);
+        auto old_size = size();
+        [[unlikely]]
+        if (old_size == capacity()) {
+            grow(size_t(old_size) + 1, ReallocateWithCopy{old_size});
+        }
+        auto& elem = data()[old_size] = value;
+        set_size(old_size + 1);
+        return elem;
+    }
+
+    void push_back(const value_type& value) {
+        emplace_back(value);
+    }
+
+    value_type pop_back() noexcept {
+        assert(not empty());
+        auto new_size = size() - 1;
+        auto value = data()[new_size];
+        set_size(new_size);
+        return value;
+    }
+
+    iterator insert(const_iterator pos, const value_type& value) {
+        return insert(pos, 1, value);
+    }
+
+    iterator insert(
+        const_iterator pos, size_type count, const value_type& value
+    ) {
+        auto fill_value = value;
+        return do_insert(pos, count, [&] (auto it) {
+            std::ranges::fill_n(it, count, fill_value);
+        });
+    }
+
+    template<std::forward_iterator Iter, std::sized_sentinel_for<Iter> Sent>
+        requires std::convertible_to<std::iter_value_t<Iter>, value_type>
+    iterator insert(const_iterator pos, Iter first, Sent last) {
+        return do_insert(pos, std::ranges::distance(first, last), [&] (auto it) {
+            copy_range(first, last, it);
+        });
+    }
+
+    template<std::ranges::forward_range R>
+        requires std::ranges::sized_range<R> and
+            std::convertible_to<std::ranges::range_value_t<R>, value_type>
+    iterator insert(const_iterator pos, R&& r) {
+        return insert(pos, std::ranges::begin(r), std::ranges::end(r));
+    }
+
+    iterator insert(
+        const_iterator pos, std::initializer_list<value_type> init
+    ) {
+        return insert(pos, init.begin(), init.end());
+    }
+
+    iterator append(size_type count, const value_type& value) {
+        return insert(end(), count, value);
+    }
+
+    template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
+        requires std::convertible_to<std::iter_value_t<Iter>, value_type>
+    iterator append(Iter first, Sent last) {
+        if constexpr (
+            std::forward_iterator<Iter> and std::sized_sentinel_for<Sent, Iter>
+        ) {
+            return insert(end(), first, last);
+        } else {
+            auto old_size = size();
+            for (; first != last; ++first) {
+                push_back(*first);
+            }
+            return begin() + old_size;
+        }
+    }
+
+    template<std::ranges::input_range R>
+        requires std::convertible_to<std::ranges::range_value_t<R>, value_type>
+    iterator append(R&& r) {
+        return append(std::ranges::begin(r), std::ranges::end(r));
+    }
+
+    iterator append(std::initializer_list<value_type> init) {
+        return insert(end(), init);
+    }
+
+    template<typename Fn>
+        requires std::convertible_to<
+            std::invoke_result_t<Fn&, value_type*, size_type>, size_type>
+    size_type append_with(size_type max_count, Fn fn) {
+        auto old_size = size();
+        if (max_count > capacity() - old_size) {
+            grow(size_t(old_size) + max_count, ReallocateWithCopy{old_size});
+        }
+        size_type written = std::invoke(fn, data() + old_size, max_count);
+        assert(written <= max_count);
+        set_size(old_size + written);
+        return written;
+    }
+
+    iterator erase(const_iterator pos) noexcept {
+        assert(pos < end());
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        assert(begin() <= first and first <= last and last <= end());
+        auto idx = std::ranges::distance(cbegin(), first);
+        auto it = begin() + idx;
+        if (first != last) {
+            auto last_idx = std::ranges::distance(cbegin(), last);
+            auto old_size = size();
+            move_elements(data() + last_idx, old_size - last_idx, data() + idx);
+            set_size(old_size - (last_idx - idx));
+        }
+        return it;
+    }
+
+    size_type shrink_to_fit() noexcept {
+        if (data_is_inlined() or not heap_data()) {
+            return capacity();
+        }
+        auto old_data = heap_data();
+        auto old_capacity = capacity();
+        auto old_size = size();
+        if (old_size <= max_inline_size()) {
+            if constexpr (HasInlineStorage) {
+                copy_elements(std::to_address(old_data), old_size, inline_data());
+                set_inline_size(old_size);
+            } else {
+                set_empty();
+            }
+            AllocTraits::deallocate(allocator(), old_data, old_capacity);
+        } else if (old_size < old_capacity) {
+            try {
+                reallocate(old_size, ReallocateWithCopy{old_size});
+            } catch (const std::bad_alloc&) {}
+        }
+        return capacity();
+    }
+
+    void swap(SmallTrivialVector& other) noexcept {
+        constexpr bool propagate =
+            AllocTraits::propagate_on_container_swap::value;
+        assert(propagate or allocators_equal(*this, other));
+        std::byte tmp[RepSize];
+        std::memcpy(tmp, m_rep, RepSize);
+        std::memcpy(m_rep, other.m_rep, RepSize);
+        std::memcpy(other.m_rep, tmp, RepSize);
+        if constexpr (propagate) {
+            std::ranges::swap(allocator(), other.allocator());
+        }
+    }
+
+private:
+    Allocator& allocator() noexcept {
+        return *this;
+    }
+
+    static bool allocators_equal(
+        const SmallTrivialVector& lhs, const SmallTrivialVector& rhs
+    ) noexcept {
+        return
+            AllocTraits::is_always_equal::value or
+            lhs.get_allocator() == rhs.get_allocator();
+    }
+
+    void range_check(size_type idx) const {
+        if (idx >= size()) {
+            throw std::out_of_range{
+                "SmallTrivialVector range check: index " +
+                std::to_string(idx) +
+                " >= size " +
+                std::to_string(size())};
+        }
+    }
+
+    static void length_check(size_t size, size_t count) {
+        if (count > max_size() - size) {
+            throw std::length_error{
+                "SmallTrivialVector length check: " +
+                std::to_string(size) +
+                " + " +
+                std::to_string(count) +
+                " > max_size " +
+                std::to_string(max_size())};
+        }
+    }
+
+    template<typename V>
+    V load(size_t offset) const noexcept {
+        V value;
+        std::memcpy(&value, m_rep + offset, sizeof(V));
+        return value;
+    }
+
+    template<typename V>
+    void store(size_t offset, V value) noexcept {
+        std::memcpy(m_rep + offset, &value, sizeof(V));
+    }
+
+    const value_type* inline_data() const noexcept {
+        return reinterpret_cast<const value_type*>(m_rep);
+    }
+
+    value_type* inline_data() noexcept {
+        return reinterpret_cast<value_type*>(m_rep);
+    }
+
+    Ptr heap_data() const noexcept {
+        return load<Ptr>(DataOffset);
+    }
+
+    void set_inline_size(size_type size) noexcept {
+        assert(size <= max_inline_size());
+        m_rep[RepSize - 1] = std::byte(size);
+    }
+
+    void set_empty() noexcept {
+        if constexpr (HasInlineStorage) {
+            set_inline_size(0);
+        } else {
+            set_heap(nullptr, 0, 0);
+        }
+    }
+
+    void set_heap(Ptr data, size_type capacity, size_type size) noexcept {
+        assert(capacity <= max_size());
+        store<Ptr>(DataOffset, data);
+        store<SizeType>(SizeOffset, size);
+        store<SizeType>(
+            CapacityOffset,
+            (capacity << CapacityShift) | (SizeType(HeapFlag) << TagShift));
+    }
+
+    void resize_uninitialized(size_type new_size) {
+        if (new_size > capacity()) {
+            grow(new_size, ReallocateWithCopy{size()});
+        }
+        set_size(new_size);
+    }
+
+    void set_size(size_type size) noexcept {
+        assert(size <= capacity());
+        if (data_is_inlined()) {
+            set_inline_size(size);
+        } else {
+            store<SizeType>(SizeOffset, size);
+        }
+    }
+
+    void deallocate() noexcept {
+        if (not data_is_inlined() and heap_data()) {
+            AllocTraits::deallocate(allocator(), heap_data(), capacity());
+        }
+    }
+
+    // Copies the first count elements over to the new buffer
+    struct ReallocateWithCopy {
+        size_type count;
+
+        void operator()(const value_type* old_data, value_type* new_data) const {
+            copy_elements(old_data, count, new_data);
+        }
+    };
+
+    // Moves the data to a new heap buffer. The size is kept, fill writes the
+    // new buffer from the old one.
+    template<typename F>
+    void reallocate(size_t new_capacity, F fill) {
+        assert(new_capacity <= max_size());
+        auto [new_data, count] =
+            TrivialVectorNameSpace::allocate_at_least(allocator(), new_capacity);
+        // fill may be handed a throwing insert, the vector is left unchanged
+        try {
+            fill(std::as_const(*this).data(), std::to_address(new_data));
+        } catch (...) {
+            AllocTraits::deallocate(allocator(), new_data, count);
+            throw;
+        }
+        auto old_size = size();
+        deallocate();
+        set_heap(new_data, std::min<size_t>(count, max_size()), old_size);
+    }
+
+    template<typename F>
+    void grow(size_t new_size, F fill) {
+        length_check(0, new_size);
+        auto new_capacity = std::min<size_t>(
+            GrowthPolicy::grow_capacity(capacity(), sizeof(value_type)),
+            max_size());
+        if (new_size < new_capacity) {
+            try {
+                reallocate(new_capacity, fill);
+                return;
+            } catch (const std::bad_alloc&) {}
+        }
+        reallocate(new_size, std::move(fill));
+    }
+
+    template<typename F>
+    iterator do_insert(const_iterator pos, size_t count, F do_assign) {
+        auto idx = std::ranges::distance(cbegin(), pos);
+        if (not count) {
+            return begin() + idx;
+        }
+        auto old_size = size();
+        [[likely]]
+        if (count <= capacity() - old_size) {
+            move_elements(data() + idx, old_size - idx, data() + idx + count);
+            do_assign(begin() + idx);
+        } else {
+            length_check(old_size, count);
+            // The inserted values may live in the old buffer, so they are
+            // copied before it is freed
+            grow(old_size + count, [&] (auto old_data, auto new_data) {
+                copy_elements(old_data, idx, new_data);
+                do_assign(new_data + idx);
+                copy_elements(
+                    old_data + idx, old_size - idx, new_data + idx + count);
+            });
+        }
+        set_size(old_size + count);
+        return begin() + idx;
+    }
+};
+
+template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
+SmallTrivialVector(Iter, Sent) -> SmallTrivialVector<std::iter_value_t<Iter>>;
+
+template<std::ranges::input_range R>
+explicit SmallTrivialVector(R&&) ->
+    SmallTrivialVector<std::ranges::range_value_t<R>>;
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+struct is_trivially_relocatable<
+    SmallTrivialVector<T, Allocator, GrowthPolicy>
+>: std::bool_constant<
+    std::is_empty_v<Allocator> or is_trivially_relocatable_v<Allocator>> {};
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void swap(
+    SmallTrivialVector<T, Allocator, GrowthPolicy>& lhs,
+    SmallTrivialVector<T, Allocator, GrowthPolicy>& rhs
+) noexcept {
+    lhs.swap(rhs);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+bool operator==(
+    const SmallTrivialVector<T, Allocator, GrowthPolicy>& lhs,
+    const SmallTrivialVector<T, Allocator, GrowthPolicy>& rhs
+) noexcept {
+    return
+        lhs.size() == rhs.size() and
+        equal_elements(lhs.data(), rhs.data(), lhs.size());
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+auto operator<=>(
+    const SmallTrivialVector<T, Allocator, GrowthPolicy>& lhs,
+    const SmallTrivialVector<T, Allocator, GrowthPolicy>& rhs
+) noexcept {
+    return compare_elements(lhs.data(), lhs.size(), rhs.data(), rhs.size());
+}
+}
+
+namespace Attractadore {
+using TrivialVectorNameSpace::SmallTrivialVector;
+
+template<
+    typename T,
+    typename Allocator = std::allocator<T>,
+    typename GrowthPolicy = DoubleGrowth
+> using CompactSmallTrivialVector =
+    SmallTrivialVector<T, CompactAllocator<Allocator>, GrowthPolicy>;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+    requires Attractadore::TrivialVectorNameSpace::ElementHashable<T>
+struct std::hash<Attractadore::SmallTrivialVector<T, Allocator, GrowthPolicy>> {
+    size_t operator()(
+        const Attractadore::SmallTrivialVector<T, Allocator, GrowthPolicy>& vec
+    ) const noexcept {
+        return vec.hash();
+    }
+};
@@ -1,32 +1,116 @@
 #pragma once
+#include "SimdKernels.hpp"
+
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <limits>
 #include <memory>
+#include <new>
 #include <span>
 #include <stdexcept>
 #include <utility>
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
 namespace Attractadore::TrivialVectorNameSpace {
-template<typename T, typename Allocator>
+// A growth policy maps the current capacity to the capacity to try next
+// when the vector runs out of space. If that fails or is not enough, the
+// vector falls back to exactly the required capacity.
+template<typename G>
+concept GrowthPolicyConcept = requires(size_t capacity, size_t value_size) {
+    { G::grow_capacity(capacity, value_size) } noexcept -> std::same_as<size_t>;
+};
+
+template<size_t Numerator, size_t Denominator = 1>
+    requires (Numerator > Denominator and Denominator != 0)
+struct GeometricGrowth {
+    static constexpr size_t grow_capacity(size_t capacity, size_t) noexcept {
+        return std::max(capacity * Numerator / Denominator, capacity + 1);
+    }
+};
+
+using DoubleGrowth = GeometricGrowth<2>;
+using HalfGrowth = GeometricGrowth<3, 2>;
+
+template<size_t Increment>
+    requires (Increment != 0)
+struct FixedGrowth {
+    static constexpr size_t grow_capacity(size_t capacity, size_t) noexcept {
+        return capacity + Increment;
+    }
+};
+
+// Grows like Base, but once the buffer spans at least a page its size is
+// rounded up to whole pages
+template<size_t PageSize = 4096, GrowthPolicyConcept Base = DoubleGrowth>
+    requires (std::has_single_bit(PageSize))
+struct PageGrowth {
+    static constexpr size_t grow_capacity(
+        size_t capacity, size_t value_size
+    ) noexcept {
+        auto new_capacity = Base::grow_capacity(capacity, value_size);
+        auto new_bytes = new_capacity * value_size;
+        if (new_bytes < PageSize) {
+            return new_capacity;
+        }
+        new_bytes = (new_bytes + PageSize - 1) & ~(PageSize - 1);
+        return new_bytes / value_size;
+    }
+};
+
+// Types whose objects can be moved to another address with memcpy, after
+// which the source bytes count as destroyed. Trivially copyable types always
+// are, others opt in by specializing.
+template<typename T>
+struct is_trivially_relocatable: std::is_trivially_copyable<T> {};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+// Vectors move their elements around with memcpy and memmove when they
+// grow, insert and erase. Elements that are trivially relocatable but not
+// trivially copyable are still constructed and destroyed one by one, and
+// the members that copy elements are only there for trivially copyable
+// ones. Moves and destruction must not throw, since a relocation is never
+// undone.
+template<typename T>
+concept RelocatableElement =
+    std::is_trivially_copyable_v<T> or (
+        is_trivially_relocatable_v<T> and
+        std::is_nothrow_move_constructible_v<T> and
+        std::is_nothrow_destructible_v<T>);
+
+template<typename T, typename Allocator, typename GrowthPolicy>
 concept TrivialVectorHeaderConcept =
-    std::is_trivial_v<T> and
-    std::same_as<typename Allocator::value_type, T>;
+    RelocatableElement<T> and
+    std::same_as<typename Allocator::value_type, T> and
+    std::unsigned_integral<typename std::allocator_traits<Allocator>::size_type> and
+    GrowthPolicyConcept<GrowthPolicy>;
 
-template<typename T, unsigned InlineCapacity, typename Allocator>
+template<typename T, unsigned InlineCapacity, typename Allocator, typename GrowthPolicy>
 concept InlineTrivialVectorConcept =
-    TrivialVectorHeaderConcept<T, Allocator>;
+    TrivialVectorHeaderConcept<T, Allocator, GrowthPolicy>;
 
 #define TRIVIAL_VECTOR_HEADER_TEMPLATE \
-template<typename T, typename Allocator> \
-    requires Attractadore::TrivialVectorNameSpace::TrivialVectorHeaderConcept<T, Allocator>
-#define TRIVIAL_VECTOR_HEADER Attractadore::TrivialVectorNameSpace::TrivialVectorHeader<T, Allocator>
+template<typename T, typename Allocator, typename GrowthPolicy, bool HasInlineStorage> \
+    requires Attractadore::TrivialVectorNameSpace::TrivialVectorHeaderConcept<T, Allocator, GrowthPolicy>
+#define TRIVIAL_VECTOR_HEADER Attractadore::TrivialVectorNameSpace::TrivialVectorHeader<T, Allocator, GrowthPolicy, HasInlineStorage>
 
 #define INLINE_TRIVIAL_VECTOR_TEMPLATE \
-template<typename T, unsigned InlineCapacity, typename Allocator> \
-    requires Attractadore::TrivialVectorNameSpace::InlineTrivialVectorConcept<T, InlineCapacity, Allocator> 
-#define INLINE_TRIVIAL_VECTOR Attractadore::TrivialVectorNameSpace::InlineTrivialVector<T, InlineCapacity, Allocator>
+template<typename T, unsigned InlineCapacity, typename Allocator, typename GrowthPolicy> \
+    requires Attractadore::TrivialVectorNameSpace::InlineTrivialVectorConcept<T, InlineCapacity, Allocator, GrowthPolicy> 
+#define INLINE_TRIVIAL_VECTOR Attractadore::TrivialVectorNameSpace::InlineTrivialVector<T, InlineCapacity, Allocator, GrowthPolicy>
 
 template<typename P>
 class VectorIterator {
@@ -134,25 +218,446 @@ public:
     }
 };
 
+template<typename Pointer, typename SizeType = size_t>
+struct AllocationResult {
+    Pointer     ptr;
+    SizeType    count;
+};
+
+// Allocators can opt into in-place growth by providing
+// try_expand(ptr, old_capacity, new_capacity) -> bool, which must leave the
+// block untouched when it returns false, and/or
+// reallocate(ptr, old_capacity, new_capacity) -> pointer, which behaves like
+// realloc: the contents are preserved and the old block is released.
+template<typename Allocator>
+concept ExpandableAllocator = requires(
+    Allocator& alloc,
+    typename std::allocator_traits<Allocator>::pointer ptr,
+    typename std::allocator_traits<Allocator>::size_type n
+) {
+    { alloc.try_expand(ptr, n, n) } -> std::same_as<bool>;
+};
+
+// try_expand_at_least(ptr, old_capacity, new_capacity) returns the new
+// capacity, which is at least new_capacity, or 0 if the block can't grow
+template<typename Allocator>
+concept ExpandableAtLeastAllocator = requires(
+    Allocator& alloc,
+    typename std::allocator_traits<Allocator>::pointer ptr,
+    typename std::allocator_traits<Allocator>::size_type n
+) {
+    { alloc.try_expand_at_least(ptr, n, n) } ->
+        std::convertible_to<typename std::allocator_traits<Allocator>::size_type>;
+};
+
+template<typename Allocator>
+concept ReallocatableAllocator = requires(
+    Allocator& alloc,
+    typename std::allocator_traits<Allocator>::pointer ptr,
+    typename std::allocator_traits<Allocator>::size_type n
+) {
+    { alloc.reallocate(ptr, n, n) } ->
+        std::same_as<typename std::allocator_traits<Allocator>::pointer>;
+};
+
+// Like std::allocator::allocate_at_least, allocate_at_least(n) and
+// reallocate_at_least(ptr, old_capacity, new_capacity) return {ptr, count}
+// where count >= n is the capacity the caller may use and must later pass
+// to deallocate
+template<typename Allocator>
+concept AtLeastAllocator = requires(
+    Allocator& alloc,
+    typename std::allocator_traits<Allocator>::size_type n
+) {
+    { alloc.allocate_at_least(n).ptr } ->
+        std::convertible_to<typename std::allocator_traits<Allocator>::pointer>;
+    { alloc.allocate_at_least(n).count } ->
+        std::convertible_to<typename std::allocator_traits<Allocator>::size_type>;
+};
+
+template<typename Allocator>
+concept ReallocatableAtLeastAllocator = requires(
+    Allocator& alloc,
+    typename std::allocator_traits<Allocator>::pointer ptr,
+    typename std::allocator_traits<Allocator>::size_type n
+) {
+    { alloc.reallocate_at_least(ptr, n, n).ptr } ->
+        std::convertible_to<typename std::allocator_traits<Allocator>::pointer>;
+    { alloc.reallocate_at_least(ptr, n, n).count } ->
+        std::convertible_to<typename std::allocator_traits<Allocator>::size_type>;
+};
+
+template<typename Allocator>
+constexpr auto allocate_at_least(
+    Allocator& alloc, typename std::allocator_traits<Allocator>::size_type n
+) -> AllocationResult<
+    typename std::allocator_traits<Allocator>::pointer,
+    typename std::allocator_traits<Allocator>::size_type
+> {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    if constexpr (AtLeastAllocator<Allocator>) {
+        auto [ptr, count] = alloc.allocate_at_least(n);
+        assert(count >= n);
+        return {ptr, count};
+    } else {
+#if __cpp_lib_allocate_at_least >= 202302L
+        auto [ptr, count] = AllocTraits::allocate_at_least(alloc, n);
+        return {ptr, count};
+#else
+        return {AllocTraits::allocate(alloc, n), n};
+#endif
+    }
+}
+
+// Allocators that can hand out zero-filled memory cheaper than filling it,
+// e.g. with calloc or fresh anonymous mappings, provide
+// allocate_zeroed(n) -> pointer or allocate_zeroed_at_least(n) -> {ptr, count}
+template<typename Allocator>
+concept ZeroingAllocator = requires(
+    Allocator& alloc,
+    typename std::allocator_traits<Allocator>::size_type n
+) {
+    { alloc.allocate_zeroed(n) } ->
+        std::convertible_to<typename std::allocator_traits<Allocator>::pointer>;
+} or requires(
+    Allocator& alloc,
+    typename std::allocator_traits<Allocator>::size_type n
+) {
+    { alloc.allocate_zeroed_at_least(n).ptr } ->
+        std::convertible_to<typename std::allocator_traits<Allocator>::pointer>;
+    { alloc.allocate_zeroed_at_least(n).count } ->
+        std::convertible_to<typename std::allocator_traits<Allocator>::size_type>;
+};
+
+template<ZeroingAllocator Allocator>
+constexpr auto allocate_zeroed_at_least(
+    Allocator& alloc, typename std::allocator_traits<Allocator>::size_type n
+) -> AllocationResult<
+    typename std::allocator_traits<Allocator>::pointer,
+    typename std::allocator_traits<Allocator>::size_type
+> {
+    if constexpr (requires { alloc.allocate_zeroed_at_least(n); }) {
+        auto [ptr, count] = alloc.allocate_zeroed_at_least(n);
+        assert(count >= n);
+        return {ptr, count};
+    } else {
+        return {alloc.allocate_zeroed(n), n};
+    }
+}
+
+// Allocators that know a faster way to prefault their memory than touching
+// every page, e.g. madvise(MADV_POPULATE_WRITE), provide
+// populate(ptr, count), which faults in the pages backing [ptr, ptr + count)
+// without changing their contents
+template<typename Allocator>
+concept PopulatingAllocator = requires(
+    Allocator& alloc,
+    typename std::allocator_traits<Allocator>::pointer ptr,
+    typename std::allocator_traits<Allocator>::size_type n
+) {
+    alloc.populate(ptr, n);
+};
+
+struct Populate {
+    explicit Populate() = default;
+};
+
+inline constexpr Populate populate{};
+
+// Requests non-temporal stores for writes of at least StreamThreshold
+// bytes, which bypass the cache instead of evicting other data from it.
+// Worth it for huge buffers that are not read again soon.
+struct Stream {
+    explicit Stream() = default;
+};
+
+inline constexpr Stream stream{};
+
+// Smallest page size on the platforms we care about, touching memory at
+// this stride faults in every page no matter how large pages really are
+inline constexpr size_t PrefaultStride = 4096;
+
+// Writes a byte into each page of [first, first + size). The bytes written
+// are inside the range, so it must not hold live data.
+inline void touch_pages(void* first, size_t size) noexcept {
+    auto begin = static_cast<volatile char*>(first);
+    auto end = begin + size;
+    for (auto p = begin; p < end; p += PrefaultStride) {
+        *p = 0;
+    }
+    if (size) {
+        end[-1] = 0;
+    }
+}
+
+// Allocators that guarantee stricter than alignof(value_type) alignment
+// advertise it with a static alignment member, which the vector then also
+// applies to its inline storage
+template<typename Allocator>
+inline constexpr size_t allocator_alignment =
+    alignof(typename Allocator::value_type);
+
+template<typename Allocator>
+    requires requires { { Allocator::alignment } -> std::convertible_to<size_t>; }
+inline constexpr size_t allocator_alignment<Allocator> = std::max<size_t>(
+    Allocator::alignment, alignof(typename Allocator::value_type));
+
+template<typename T, size_t Alignment>
+    requires (std::has_single_bit(Alignment) and Alignment >= alignof(T))
+struct AlignedAllocator {
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    static constexpr size_t alignment = Alignment;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, std::max(Alignment, alignof(U))>;
+    };
+
+    constexpr AlignedAllocator() noexcept = default;
+    template<typename U, size_t A>
+    constexpr AlignedAllocator(const AlignedAllocator<U, A>&) noexcept {}
+
+    [[nodiscard]] T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length{};
+        }
+        return static_cast<T*>(
+            ::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        ::operator delete(p, n * sizeof(T), std::align_val_t{Alignment});
+    }
+
+    friend constexpr bool operator==(
+        const AlignedAllocator&, const AlignedAllocator&
+    ) noexcept = default;
+};
+
+// Bulk copies of trivially copyable elements call memcpy and memmove
+// directly rather than relying on std::copy being lowered to them, which
+// unoptimized builds don't do. For elements that are only trivially
+// relocatable they are relocations, which can't be constant evaluated.
+template<typename T>
+constexpr T* copy_elements(const T* src, size_t count, T* dst) noexcept {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if (std::is_constant_evaluated()) {
+            return std::copy_n(src, count, dst);
+        }
+    }
+    if (count) {
+        std::memcpy(static_cast<void*>(dst), src, count * sizeof(T));
+    }
+    return dst + count;
+}
+
+// Like copy_elements, but the source and destination may overlap
+template<typename T>
+constexpr T* move_elements(const T* src, size_t count, T* dst) noexcept {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if (std::is_constant_evaluated()) {
+            if (dst < src) {
+                return std::copy_n(src, count, dst);
+            }
+            return std::copy_backward(src, src + count, dst + count);
+        }
+    }
+    if (count) {
+        std::memmove(static_cast<void*>(dst), src, count * sizeof(T));
+    }
+    return dst + count;
+}
+
+// Copies [first, last) to out, as a single memmove if the source is
+// contiguous and holds the same type
+template<std::input_iterator Iter, std::sentinel_for<Iter> Sent, typename Out>
+constexpr Out copy_range(Iter first, Sent last, Out out) {
+    if constexpr (
+        std::contiguous_iterator<Iter> and
+        std::sized_sentinel_for<Sent, Iter> and
+        std::contiguous_iterator<Out> and
+        std::same_as<std::iter_value_t<Iter>, std::iter_value_t<Out>>
+    ) {
+        auto count = last - first;
+        move_elements(std::to_address(first), count, std::to_address(out));
+        return out + count;
+    } else {
+        return std::ranges::copy(std::move(first), std::move(last), out).out;
+    }
+}
+
+// Whether filling with value is the same as zeroing memory
+template<typename T>
+constexpr bool is_zero_bits(const T& value) noexcept {
+    if (std::is_constant_evaluated()) {
+        return false;
+    }
+    auto bytes = std::bit_cast<std::array<unsigned char, sizeof(T)>>(value);
+    return std::ranges::all_of(bytes, [] (auto b) { return b == 0; });
+}
+
+template<typename T>
+struct MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    constexpr MallocAllocator() noexcept = default;
+    template<typename U>
+    constexpr MallocAllocator(const MallocAllocator<U>&) noexcept {}
+
+    [[nodiscard]] T* allocate(size_t n) {
+        return reallocate(nullptr, 0, n);
+    }
+
+    [[nodiscard]] AllocationResult<T*> allocate_at_least(size_t n) {
+        return reallocate_at_least(nullptr, 0, n);
+    }
+
+    [[nodiscard]] AllocationResult<T*> allocate_zeroed_at_least(size_t n) {
+        auto p = static_cast<T*>(std::calloc(n, sizeof(T)));
+        if (not p and n) {
+            throw std::bad_alloc{};
+        }
+        return {p, usable_size(p, n)};
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        std::free(p);
+    }
+
+    [[nodiscard]] T* reallocate(T* p, size_t, size_t new_n) {
+        if (new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length{};
+        }
+        auto new_p = static_cast<T*>(std::realloc(p, new_n * sizeof(T)));
+        if (not new_p and new_n) {
+            throw std::bad_alloc{};
+        }
+        return new_p;
+    }
+
+    [[nodiscard]] AllocationResult<T*> reallocate_at_least(
+        T* p, size_t old_n, size_t new_n
+    ) {
+        auto new_p = reallocate(p, old_n, new_n);
+        return {new_p, usable_size(new_p, new_n)};
+    }
+
+    friend constexpr bool operator==(
+        const MallocAllocator&, const MallocAllocator&
+    ) noexcept = default;
+
+private:
+    static size_t usable_size(T* p, size_t n) noexcept {
+#if defined(__GLIBC__)
+        return p ? malloc_usable_size(p) / sizeof(T) : n;
+#elif defined(__APPLE__)
+        return p ? malloc_size(p) / sizeof(T) : n;
+#else
+        return n;
+#endif
+    }
+};
+
+// Counts elements in SizeType instead of Allocator's size_type. Vectors take
+// their size_type from the allocator, so with 32-bit sizes the size and
+// capacity pack next to the data pointer in 16 bytes. Capacities that the
+// underlying allocator reports are clamped to what SizeType can hold, which
+// the at-least protocols allow.
+template<typename Allocator, std::unsigned_integral SizeType = uint32_t>
+struct CompactAllocator: Allocator {
+    using BaseTraits = std::allocator_traits<Allocator>;
+    using value_type = BaseTraits::value_type;
+    using pointer = BaseTraits::pointer;
+    using size_type = SizeType;
+    using difference_type = std::make_signed_t<SizeType>;
+
+    template<typename U>
+    struct rebind {
+        using other = CompactAllocator<
+            typename BaseTraits::template rebind_alloc<U>, SizeType>;
+    };
+
+    constexpr CompactAllocator() = default;
+    constexpr CompactAllocator(Allocator alloc) noexcept:
+        Allocator(std::move(alloc)) {}
+    template<typename A>
+    constexpr CompactAllocator(const CompactAllocator<A, SizeType>& other) noexcept:
+        Allocator(other.base()) {}
+
+    constexpr const Allocator& base() const noexcept { return *this; }
+    constexpr Allocator& base() noexcept { return *this; }
+
+    static constexpr size_type max_size() noexcept {
+        return std::numeric_limits<size_type>::max() / sizeof(value_type);
+    }
+
+    [[nodiscard]] constexpr AllocationResult<pointer, size_type>
+    allocate_at_least(size_type n) {
+        auto [ptr, count] = TrivialVectorNameSpace::allocate_at_least(base(), n);
+        return {ptr, clamp(count)};
+    }
+
+    [[nodiscard]] constexpr AllocationResult<pointer, size_type>
+    allocate_zeroed_at_least(size_type n) requires ZeroingAllocator<Allocator> {
+        auto [ptr, count] =
+            TrivialVectorNameSpace::allocate_zeroed_at_least(base(), n);
+        return {ptr, clamp(count)};
+    }
+
+    constexpr size_type try_expand_at_least(
+        pointer p, size_type old_n, size_type new_n
+    ) requires ExpandableAtLeastAllocator<Allocator> {
+        return clamp(base().try_expand_at_least(p, old_n, new_n));
+    }
+
+    [[nodiscard]] constexpr AllocationResult<pointer, size_type>
+    reallocate_at_least(
+        pointer p, size_type old_n, size_type new_n
+    ) requires ReallocatableAtLeastAllocator<Allocator> {
+        auto [ptr, count] = base().reallocate_at_least(p, old_n, new_n);
+        return {ptr, clamp(count)};
+    }
+
+private:
+    static constexpr size_type clamp(size_t count) noexcept {
+        return std::min<size_t>(count, max_size());
+    }
+};
+
+// HasInlineStorage is false for vectors that never store their data inline,
+// for which data() is a plain load of the data pointer
 template<
     typename T,
-    typename Allocator = std::allocator<T>
-> requires TrivialVectorHeaderConcept<T, Allocator>
+    typename Allocator = std::allocator<T>,
+    typename GrowthPolicy = DoubleGrowth,
+    bool HasInlineStorage = true
+> requires TrivialVectorHeaderConcept<T, Allocator, GrowthPolicy>
 class TrivialVectorHeader: private Allocator {
 protected:
     using AllocTraits = std::allocator_traits<Allocator>;
     using Ptr = AllocTraits::pointer;
     using PtrTraits = std::pointer_traits<Ptr>;
     using ConstPtr = AllocTraits::const_pointer;
+    using SizeType = AllocTraits::size_type;
 
-    Ptr     m_data;
-    size_t  m_capacity;
-    size_t  m_size;
+    // Null while the elements live in the inline storage, so that the
+    // object never points into itself
+    Ptr         m_data;
+    SizeType    m_capacity;
+    SizeType    m_size;
 
 public:
     using value_type = T;
     using allocator_type = Allocator;
-    using size_type = size_t;
+    using growth_policy = GrowthPolicy;
+    using size_type = SizeType;
     using difference_type = ptrdiff_t;
     using reference = value_type&;
     using const_reference = const value_type&;
@@ -163,6 +668,8 @@ public:
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+    static constexpr size_t alignment = allocator_alignment<Allocator>;
+
     static_assert(std::contiguous_iterator<iterator>);
     static_assert(std::contiguous_iterator<const_iterator>);
     static_assert(std::convertible_to<iterator, const_iterator>);
@@ -193,7 +700,7 @@ protected:
 public:
     constexpr TrivialVectorHeader& operator=(
         const TrivialVectorHeader& other
-    ) {
+    ) requires std::is_trivially_copyable_v<T> {
         constexpr bool propagate =
             AllocTraits::propagate_on_container_copy_assignment::value;
         if constexpr (propagate) {
@@ -203,8 +710,9 @@ public:
                     capacity() < other.size();
                 if (must_realloc) {
                     auto alloc = other.get_allocator();
-                    auto new_capacity = other.size();
-                    auto new_data = AllocTraits::allocate(alloc, new_capacity);
+                    auto [new_data, new_capacity] =
+                        TrivialVectorNameSpace::allocate_at_least(
+                            alloc, other.size());
                     deallocate();
                     allocator() = std::move(alloc);
                     m_data = new_data;
@@ -218,24 +726,37 @@ public:
         return *this;
     }
 
-    constexpr TrivialVectorHeader& operator=(std::initializer_list<value_type> init) {
+    constexpr TrivialVectorHeader& operator=(
+        std::initializer_list<value_type> init
+    ) requires std::is_trivially_copyable_v<T> {
         assign(init);
         return *this;
     }
 
-    constexpr void assign(size_type count, const value_type& value) {
+    constexpr void assign(size_type count, const value_type& value)
+        requires std::is_trivially_copyable_v<T>
+    {
+        if constexpr (ZeroingAllocator<Allocator>) {
+            if (count > capacity() and is_zero_bits(value)) {
+                grow(count, 0, ReallocateZeroed());
+                m_size = count;
+                return;
+            }
+        }
         fit(count);
         std::ranges::fill(*this, value);
     }
 
     template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
         requires std::convertible_to<
-            std::iter_value_t<Iter>, value_type>
+            std::iter_value_t<Iter>, value_type> and
+            std::is_trivially_copyable_v<T>
     constexpr void assign(Iter first, Sent last) {
         if constexpr (std::sized_sentinel_for<Sent, Iter>) {
             auto new_size = std::ranges::distance(first, last);
+            length_check(0, new_size);
             fit(new_size);
-            std::ranges::copy(first, last, data());
+            copy_range(first, last, data());
         } else {
             clear();
             append(first, last);
@@ -244,18 +765,53 @@ public:
 
     template<std::ranges::input_range R>
         requires std::convertible_to<
-            std::ranges::range_value_t<R>, value_type>
+            std::ranges::range_value_t<R>, value_type> and
+            std::is_trivially_copyable_v<T>
     constexpr void assign(R&& r) {
         if constexpr (std::ranges::sized_range<R>) {
             auto new_size = std::ranges::size(r);
+            length_check(0, new_size);
             fit(new_size);
-            std::ranges::copy(std::forward<R>(r), data());
+            copy_range(std::ranges::begin(r), std::ranges::end(r), data());
         } else {
             assign(std::ranges::begin(r), std::ranges::end(r));
         }
     }
 
-    constexpr void assign(std::initializer_list<value_type> init) {
+    constexpr void assign(
+        size_type count, const value_type& value, Stream
+    ) requires std::is_trivially_copyable_v<T> {
+        if constexpr (ZeroingAllocator<Allocator>) {
+            if (count > capacity() and is_zero_bits(value)) {
+                grow(count, 0, ReallocateZeroed());
+                m_size = count;
+                return;
+            }
+        }
+        auto fill_value = value;
+        fit(count);
+        stream_fill(data(), count, fill_value);
+    }
+
+    // Only contiguous ranges of value_type are streamed
+    template<std::ranges::input_range R>
+        requires std::convertible_to<
+            std::ranges::range_value_t<R>, value_type> and
+            std::is_trivially_copyable_v<T>
+    constexpr void assign(R&& r, Stream) {
+        if constexpr (ContiguousRangeOf<R, value_type>) {
+            auto new_size = std::ranges::size(r);
+            length_check(0, new_size);
+            fit(new_size);
+            stream_copy(std::ranges::data(r), new_size, data());
+        } else {
+            assign(std::forward<R>(r));
+        }
+    }
+
+    constexpr void assign(std::initializer_list<value_type> init)
+        requires std::is_trivially_copyable_v<T>
+    {
         assign(init.begin(), init.end());
     }
 
@@ -272,6 +828,9 @@ public:
     ) noexcept requires std::is_move_assignable_v<Allocator> {
         // TODO: is it OK if capacity <= max_inline_size()?
         assert(size <= capacity);
+        assert(ptr or not capacity);
+        assert(std::bit_cast<uintptr_t>(std::to_address(ptr)) % alignment == 0);
+        destroy_elements(data(), data() + m_size);
         deallocate();
         m_data = ptr;
         m_capacity = capacity;
@@ -292,45 +851,59 @@ private:
         }
     }
 
+    // Sizes are checked in size_t before they are narrowed to size_type,
+    // so that neither can wrap around
+    static constexpr void length_check(size_t size, size_t count) {
+        if (count > max_size() - size) {
+            throw std::length_error{
+                "TrivialVector length check: " +
+                std::to_string(size) +
+                " + " +
+                std::to_string(count) +
+                " > max_size " +
+                std::to_string(max_size())};
+        }
+    }
+
 public:
     constexpr const_reference at(size_type idx) const {
         range_check(idx);
-        return m_data[idx];
+        return data()[idx];
     }
 
     constexpr reference at(size_type idx) {
         range_check(idx);
-        return m_data[idx];
+        return data()[idx];
     }
 
     constexpr const_reference operator[](size_type idx) const noexcept {
         assert(idx < size());
-        return m_data[idx];
+        return data()[idx];
     }
 
     constexpr reference operator[](size_type idx) noexcept {
         assert(idx < size());
-        return m_data[idx];
+        return data()[idx];
     }
 
     constexpr const_reference front() const noexcept {
         assert(not empty());
-        return m_data[0];
+        return data()[0];
     }
 
     constexpr reference front() noexcept {
         assert(not empty());
-        return m_data[0];
+        return data()[0];
     }
 
     constexpr const_reference back() const noexcept {
         assert(not empty());
-        return m_data[size() - 1];
+        return data()[size() - 1];
     }
 
     constexpr reference back() noexcept {
         assert(not empty());
-        return m_data[size() - 1];
+        return data()[size() - 1];
     }
 
     constexpr const value_type* cdata() const noexcept {
@@ -338,11 +911,11 @@ public:
     }
 
     constexpr const value_type* data() const noexcept {
-        return std::to_address(m_data);
+        return std::assume_aligned<alignment>(std::to_address(data_ptr()));
     }
 
     constexpr value_type* data() noexcept {
-        return std::to_address(m_data);
+        return std::assume_aligned<alignment>(std::to_address(data_ptr()));
     }
 
     constexpr const_iterator cbegin() const noexcept {
@@ -354,19 +927,19 @@ public:
     }
 
     constexpr const_iterator begin() const noexcept {
-        return const_iterator{m_data};
+        return const_iterator{data_ptr()};
     }
 
     constexpr const_iterator end() const noexcept {
-        return const_iterator{m_data + size()};
+        return const_iterator{data_ptr() + size()};
     }
 
     constexpr iterator begin() noexcept {
-        return iterator{m_data};
+        return iterator{data_ptr()};
     }
 
     constexpr iterator end() noexcept {
-        return iterator{m_data + size()};
+        return iterator{data_ptr() + size()};
     }
 
     constexpr const_reverse_iterator crbegin() const noexcept {
@@ -419,17 +992,73 @@ public:
             reinterpret_cast<std::byte*>(data()), size_bytes()};
     }
 
+    static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+    // Searches for value with vector compares when T is an integer, float
+    // or double
+    constexpr const_iterator find(const value_type& value) const noexcept {
+        return begin() + find_index(data(), size(), value);
+    }
+
+    constexpr iterator find(const value_type& value) noexcept {
+        return begin() + find_index(data(), size(), value);
+    }
+
+    constexpr bool contains(const value_type& value) const noexcept {
+        return find_index(data(), size(), value) != size();
+    }
+
+    constexpr size_type index_of(const value_type& value) const noexcept {
+        auto idx = find_index(data(), size(), value);
+        return idx != size() ? idx : npos;
+    }
+
+    constexpr size_type count(const value_type& value) const noexcept {
+        return count_equal(data(), size(), value);
+    }
+
+    // Hashes the bytes of scalar elements and std::hash of anything else
+    size_t hash() const noexcept requires ElementHashable<T> {
+        return hash_elements(data(), size());
+    }
+
     constexpr size_type reserve(size_type new_capacity) {
         if (new_capacity > capacity()) {
+            length_check(0, new_capacity);
             reallocate(new_capacity);
         }
         return capacity();
     }
 
     constexpr size_type reserve_more(size_type additional_capacity) {
+        length_check(size(), additional_capacity);
         return reserve(size() + additional_capacity);
     }
 
+    // Also prefaults the spare capacity, so that filling it later does not
+    // take page faults
+    constexpr size_type reserve(size_type new_capacity, Populate) {
+        reserve(new_capacity);
+        auto spare = data() + size();
+        auto spare_count = capacity() - size();
+        if (not spare_count or data_is_inlined()) {
+            return capacity();
+        }
+        if constexpr (PopulatingAllocator<Allocator>) {
+            allocator().populate(m_data + size(), spare_count);
+        } else {
+            touch_pages(spare, spare_count * sizeof(value_type));
+        }
+        return capacity();
+    }
+
+    constexpr size_type reserve_more(
+        size_type additional_capacity, Populate
+    ) {
+        length_check(size(), additional_capacity);
+        return reserve(size() + additional_capacity, populate);
+    }
+
     constexpr size_type capacity() const noexcept {
         return m_capacity;
     }
@@ -439,17 +1068,40 @@ public:
     }
 
 protected:
+    // Whether [first, last) may refer to elements of this vector, which
+    // then have to be read before the buffer is reallocated. Only
+    // contiguous ranges can be told apart from the buffer.
+    template<typename Iter, typename Sent>
+    constexpr bool may_alias(Iter first, Sent last) const noexcept {
+        if constexpr (
+            std::contiguous_iterator<Iter> and std::sized_sentinel_for<Sent, Iter>
+        ) {
+            if (std::is_constant_evaluated()) {
+                return true;
+            }
+            auto src = reinterpret_cast<uintptr_t>(std::to_address(first));
+            auto src_end = src + (last - first) * sizeof(std::iter_value_t<Iter>);
+            auto buf = reinterpret_cast<uintptr_t>(data());
+            auto buf_end = buf + capacity() * sizeof(value_type);
+            return src < buf_end and buf < src_end;
+        } else {
+            return true;
+        }
+    }
+
+    // do_assign(it) writes the inserted elements starting at it. If it
+    // reads from this vector's buffer, reads_buffer must be set.
     template<typename F>
     constexpr iterator do_sized_insert(
-        const_iterator pos, size_t count, F do_assign
+        const_iterator pos, size_t count, F do_assign, bool reads_buffer
     ) {
         assert(count);
-        auto new_size = size() + count;
         [[likely]]
-        if (new_size <= capacity()) {
+        if (count <= capacity() - size()) {
             return do_sized_place(pos, count, std::move(do_assign));
         } else {
-            return do_sized_realloc_insert(pos, count, std::move(do_assign));
+            return do_sized_realloc_insert(
+                pos, count, std::move(do_assign), reads_buffer);
         };
     }
 
@@ -462,26 +1114,39 @@ protected:
         auto new_size = size() + count;
         assert(new_size <= capacity());
         auto assign_begin = begin() + idx;
-        auto old_end = end();
+        move_elements(data() + idx, size() - idx, data() + idx + count);
         m_size = new_size;
-        std::ranges::copy_backward(assign_begin, old_end, end());
         do_assign(assign_begin);
         return assign_begin;
     }
 
     template<typename F>
     constexpr iterator do_sized_realloc_insert(
-        const_iterator pos, size_t count, F do_assign
+        const_iterator pos, size_t count, F do_assign, bool reads_buffer
     ) {
         assert(count);
+        length_check(size(), count);
+        size_type new_size = size() + count;
+        // Growing in place keeps every element where it is, which
+        // allocators that promise stable pointers rely on
+        if (grow_in_place(new_size)) {
+            return do_sized_place(pos, count, std::move(do_assign));
+        }
         auto idx = std::ranges::distance(begin(), pos);
-        auto new_size = size() + count;
-        grow_to(new_size, [&] (auto old_data, auto cnt, auto new_data) {
-            auto assign_begin =
-                std::ranges::copy_n(old_data, idx, new_data).out;
-            auto assign_end = do_assign(assign_begin);
-            std::ranges::copy(old_data + idx, old_data + cnt, assign_end);
-        });
+        if (size_t(idx) == size() and not reads_buffer) {
+            // Appending only needs the old contents moved over, which lets
+            // the allocator reallocate the buffer, unless the appended
+            // range lives in it
+            grow_to(new_size);
+            do_assign(begin() + idx);
+        } else {
+            grow_to(new_size, [&] (auto old_data, auto cnt, auto new_data) {
+                auto assign_begin =
+                    copy_elements(old_data, idx, std::to_address(new_data));
+                auto assign_end = do_assign(assign_begin);
+                copy_elements(old_data + idx, cnt - idx, assign_end);
+            });
+        }
         m_size = new_size;
         return begin() + idx;
     }
@@ -492,11 +1157,14 @@ public:
     constexpr iterator emplace(
         const_iterator pos, Args&&... args 
     ) {
+        // Args may refer to elements that a reallocation frees
+        value_type value(std::forward<Args>(args)...);
         return do_sized_insert(pos, 1,
             [&] (auto it) {
-                *it = value_type(std::forward<Args>(args)...);
+                std::construct_at(std::to_address(it), std::move(value));
                 return ++it;
-            }
+            },
+            false
         );
     }
 
@@ -506,12 +1174,19 @@ public:
         return emplace(pos, value);
     }
 
+    constexpr iterator insert(
+        const_iterator pos, value_type&& value
+    ) {
+        return emplace(pos, std::move(value));
+    }
+
     constexpr iterator place(
         const_iterator pos, size_type count
-    ) {
+    ) requires std::is_trivially_copyable_v<T> {
         if (count) {
             return do_sized_insert(pos, count,
-                [&] (auto it) { return it + count; }
+                [&] (auto it) { return it + count; },
+                false
             );
         } else {
             return begin() + std::ranges::distance(begin(), pos);
@@ -520,12 +1195,13 @@ public:
 
     constexpr iterator insert(
         const_iterator pos, size_type count, const value_type& value
-    ) {
+    ) requires std::is_trivially_copyable_v<T> {
         if (count) {
             return do_sized_insert(pos, count,
-                [&] (auto it) {
+                [&, value = value] (auto it) {
                     return std::ranges::fill_n(it, count, value);
-                }
+                },
+                false
             );
         } else {
             return begin() + std::ranges::distance(begin(), pos);
@@ -534,7 +1210,8 @@ public:
 
     template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
         requires std::convertible_to<
-            std::iter_value_t<Iter>, value_type>
+            std::iter_value_t<Iter>, value_type> and
+            std::is_trivially_copyable_v<T>
     constexpr iterator insert(
         const_iterator pos, Iter first, Sent last
     ) {
@@ -543,8 +1220,9 @@ public:
             if (count) {
                 return do_sized_insert(pos, count,
                     [&] (auto it) {
-                        return std::ranges::copy(first, last, it).out;
-                    }
+                        return copy_range(first, last, it);
+                    },
+                    may_alias(first, last)
                 );
             } else {
                 return begin() + std::ranges::distance(begin(), pos);
@@ -559,7 +1237,7 @@ public:
             };
             append_some();
             while (first != last) {
-                grow(new_size + 1, new_size);
+                grow(size_t(new_size) + 1, new_size);
                 append_some();
             }
             std::ranges::rotate(
@@ -573,16 +1251,18 @@ public:
 
     template<std::ranges::input_range R>
         requires std::convertible_to<
-            std::ranges::range_value_t<R>, value_type>
+            std::ranges::range_value_t<R>, value_type> and
+            std::is_trivially_copyable_v<T>
     constexpr iterator insert(const_iterator pos, R&& r) {
         if constexpr (std::ranges::sized_range<R>) {
             auto count = std::ranges::size(r);
             if (count) {
                 return do_sized_insert(pos, count,
                     [&] (auto it) {
-                        return std::ranges::copy(
-                            std::forward<R>(r), it).out;
-                    }
+                        return copy_range(
+                            std::ranges::begin(r), std::ranges::end(r), it);
+                    },
+                    may_alias(std::ranges::begin(r), std::ranges::end(r))
                 );
             } else {
                 return begin() + std::ranges::distance(begin(), pos);
@@ -594,52 +1274,124 @@ public:
 
     constexpr iterator insert(
         const_iterator pos, std::initializer_list<value_type> init
-    ) {
+    ) requires std::is_trivially_copyable_v<T> {
         return insert(pos, init.begin(), init.end());
     }
 
-    constexpr iterator append(size_type count, const value_type& value) {
+    constexpr iterator append(size_type count, const value_type& value)
+        requires std::is_trivially_copyable_v<T>
+    {
         return insert(end(), count, value);
     }
 
-    constexpr iterator place_back(size_type count) {
+    constexpr iterator place_back(size_type count)
+        requires std::is_trivially_copyable_v<T>
+    {
         return place(end(), count);
     }
 
+    // Lets fn write up to max_count elements past the end in one pass and
+    // keeps as many as it returns, like std::string::resize_and_overwrite.
+    // fn is called as fn(value_type* dst, size_type max_count). The size
+    // does not change if it throws.
+    template<typename Fn>
+        requires std::convertible_to<
+            std::invoke_result_t<Fn&, value_type*, size_type>, size_type> and
+            std::is_trivially_copyable_v<T>
+    constexpr size_type append_with(size_type max_count, Fn fn) {
+        if (max_count > capacity() - size()) {
+            grow_to(size_t(size()) + max_count);
+        }
+        size_type written = std::invoke(fn, data() + size(), max_count);
+        assert(written <= max_count);
+        m_size += written;
+        return written;
+    }
+
     template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
         requires std::convertible_to<
-            std::iter_value_t<Iter>, value_type>
+            std::iter_value_t<Iter>, value_type> and
+            std::is_trivially_copyable_v<T>
     constexpr iterator append(Iter first, Sent last) {
         return insert(end(), first, last);
     }
 
     template<std::ranges::input_range R>
         requires std::convertible_to<
-            std::ranges::range_value_t<R>, value_type>
+            std::ranges::range_value_t<R>, value_type> and
+            std::is_trivially_copyable_v<T>
     constexpr iterator append(R&& r) {
         return insert(end(), std::forward<R>(r));
     }
 
-    constexpr iterator append(std::initializer_list<value_type> init) {
+    constexpr iterator append(
+        size_type count, const value_type& value, Stream
+    ) requires std::is_trivially_copyable_v<T> {
+        auto old_size = size();
+        auto fill_value = value;
+        if (count > capacity() - old_size) {
+            grow_to(size_t(old_size) + count);
+        }
+        stream_fill(data() + old_size, count, fill_value);
+        m_size += count;
+        return begin() + old_size;
+    }
+
+    // Only contiguous ranges of value_type are streamed
+    template<std::ranges::input_range R>
+        requires std::convertible_to<
+            std::ranges::range_value_t<R>, value_type> and
+            std::is_trivially_copyable_v<T>
+    constexpr iterator append(R&& r, Stream) {
+        if constexpr (ContiguousRangeOf<R, value_type>) {
+            auto src = std::ranges::data(r);
+            auto count = std::ranges::size(r);
+            // The normal path copies a range from this vector before
+            // reallocating
+            if (may_alias(src, src + count)) {
+                return append(std::forward<R>(r));
+            }
+            auto old_size = size();
+            length_check(old_size, count);
+            if (count > capacity() - old_size) {
+                grow_to(size_t(old_size) + count);
+            }
+            stream_copy(src, count, data() + old_size);
+            m_size += count;
+            return begin() + old_size;
+        } else {
+            return append(std::forward<R>(r));
+        }
+    }
+
+    constexpr iterator append(std::initializer_list<value_type> init)
+        requires std::is_trivially_copyable_v<T>
+    {
         return insert(end(), init);
     }
 
     template<typename... Args>
         requires std::constructible_from<value_type, Args&&...>
     constexpr reference emplace_back(Args&&... args) {
+        value_type value(std::forward<Args>(args)...);
         [[unlikely]]
         if (size() == capacity()) {
-            grow_to(size() + 1);
+            grow_to(size_t(size()) + 1);
         }
-        return data()[m_size++] =
-            value_type(std::forward<Args>(args)...);
+        return *std::construct_at(data() + m_size++, std::move(value));
     }
 
     constexpr void push_back(const value_type& value) {
         emplace_back(value);
     }
 
-    constexpr reference shove_back(const value_type& value) noexcept {
+    constexpr void push_back(value_type&& value) {
+        emplace_back(std::move(value));
+    }
+
+    constexpr reference shove_back(const value_type& value) noexcept
+        requires std::is_trivially_copyable_v<T>
+    {
         assert(size() < capacity());
         return data()[m_size++] = value;
     }
@@ -648,7 +1400,8 @@ public:
         assert(pos < end());
         auto idx = std::ranges::distance(begin(), pos);
         auto it = begin() + idx;
-        std::ranges::copy(pos + 1, end(), it);
+        destroy_elements(data() + idx, data() + idx + 1);
+        move_elements(data() + idx + 1, size() - idx - 1, data() + idx);
         m_size--;
         return it;
     }
@@ -660,8 +1413,10 @@ public:
         auto idx = std::ranges::distance(begin(), first);
         auto it = begin() + idx;
         if (first != last) {
-            auto new_end = std::ranges::copy(last, end(), it).out;
-            m_size = std::ranges::distance(begin(), new_end);
+            auto last_idx = std::ranges::distance(begin(), last);
+            destroy_elements(data() + idx, data() + last_idx);
+            move_elements(data() + last_idx, size() - last_idx, data() + idx);
+            m_size -= last_idx - idx;
         }
         return it;
     }
@@ -675,30 +1430,186 @@ public:
 
     constexpr value_type pop_back() noexcept {
         assert(not empty());
-        return data()[--m_size];
+        auto last = data() + --m_size;
+        value_type value(std::move(*last));
+        destroy_elements(last, last + 1);
+        return value;
     }
 
     constexpr iterator swap_pop(const_iterator it) noexcept {
         assert(not empty());
         auto idx = std::ranges::distance(begin(), it);
-        std::ranges::swap(data()[idx], data()[--m_size]);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::ranges::swap(data()[idx], data()[--m_size]);
+        } else {
+            // The last element is relocated into the hole
+            destroy_elements(data() + idx, data() + idx + 1);
+            if (size_t(idx) != --m_size) {
+                copy_elements(data() + size(), 1, data() + idx);
+            }
+        }
         return begin() + idx;
     }
 
-    constexpr void resize(size_type new_size) {
+    // Erases the elements at indices, which must be distinct, by moving the
+    // elements that survive past the new end into the holes. Like repeated
+    // swap_pop this does not keep the order, but each surviving element
+    // moves at most once and the cost is O(indices.size()). indices is
+    // reordered in the process.
+    constexpr void swap_pop_many(std::span<size_t> indices) noexcept {
+        assert(indices.size() <= size());
+        auto k = indices.size();
+        auto new_size = size() - k;
+        // Put every index into the tail [new_size, size()) at slot
+        // index - new_size. Every swap settles one index for good. The
+        // slots left over then hold the holes below new_size, each one
+        // paired with the surviving tail element of its slot.
+        for (size_t i = 0; i < k; i++) {
+            while (indices[i] >= new_size and indices[i] != new_size + i) {
+                assert(indices[i] < size());
+                auto& other = indices[indices[i] - new_size];
+                assert(other != indices[i]);
+                std::swap(indices[i], other);
+            }
+        }
+        for (size_t i = 0; i < k; i++) {
+            destroy_elements(data() + indices[i], data() + indices[i] + 1);
+        }
+        for (size_t i = 0; i < k; i++) {
+            if (indices[i] < new_size) {
+                copy_elements(data() + new_size + i, 1, data() + indices[i]);
+            }
+        }
+        m_size = new_size;
+    }
+
+    // Erases the elements at indices, which must be sorted, and returns how
+    // many were erased. Repeated indices are erased once. The survivors keep
+    // their order and each run of them between erased elements is moved
+    // once, so the cost is O(size()) however many elements go.
+    constexpr size_type erase_indices(std::span<const size_t> indices) noexcept {
+        size_t out = indices.empty() ? size() : indices.front();
+        size_t run = out;
+        for (auto idx: indices) {
+            assert(idx < size() and idx + 1 >= run);
+            if (idx < run) {
+                continue;
+            }
+            destroy_elements(data() + idx, data() + idx + 1);
+            move_elements(data() + run, idx - run, data() + out);
+            out += idx - run;
+            run = idx + 1;
+        }
+        return compact_tail(out, run);
+    }
+
+    // Erases the elements whose bit is set in mask, bit i % 64 of word
+    // i / 64 standing for element i, and returns how many were erased.
+    // Elements past the end of mask are kept. Like erase_indices, except
+    // that blocks with many erased elements are packed with compress_block
+    // instead of one move per run.
+    constexpr size_type erase_mask(std::span<const uint64_t> mask) noexcept {
+        size_t out = 0;
+        size_t run = 0;
+        auto words = std::min<size_t>(mask.size(), (size_t(size()) + 63) / 64);
+        for (size_t w = 0; w < words; w++) {
+            auto base = 64 * w;
+            auto count = std::min<size_t>(size() - base, 64);
+            auto bits = mask[w] & low_bits(count);
+            // compress_block assigns elements, so only trivially copyable
+            // ones can be packed with it
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                if (std::popcount(bits) > EraseMaskSparseRuns) {
+                    move_elements(data() + run, base - run, data() + out);
+                    out += base - run;
+                    out = compress_block(
+                        data() + base, count, ~bits, data() + out) - data();
+                    run = base + count;
+                    continue;
+                }
+            }
+            for (; bits; bits &= bits - 1) {
+                auto idx = base + std::countr_zero(bits);
+                destroy_elements(data() + idx, data() + idx + 1);
+                move_elements(data() + run, idx - run, data() + out);
+                out += idx - run;
+                run = idx + 1;
+            }
+        }
+        return compact_tail(out, run);
+    }
+
+private:
+    // Blocks of 64 elements with more erased ones than this are packed
+    // element by element rather than moved run by run
+    static constexpr int EraseMaskSparseRuns = 4;
+
+    // Moves the last run of survivors, [run, size()), down to out
+    constexpr size_type compact_tail(size_t out, size_t run) noexcept {
+        move_elements(data() + run, size() - run, data() + out);
+        auto erased = run - out;
+        m_size -= erased;
+        return erased;
+    }
+
+public:
+
+    // New elements are default-initialized, which leaves them
+    // uninitialized for trivially default constructible types
+    constexpr void resize(size_type new_size)
+        requires std::default_initializable<value_type>
+    {
+        auto old_size = size();
         if (capacity() < new_size) {
             grow_to(new_size);
         }
+        if (new_size > old_size) {
+            default_construct(data() + old_size, data() + new_size);
+        } else {
+            destroy_elements(data() + new_size, data() + old_size);
+        }
         m_size = new_size;
     }
 
     constexpr void resize(
         size_type new_size, const value_type& value
-    ) {
+    ) requires std::is_trivially_copyable_v<T> {
+        if constexpr (ZeroingAllocator<Allocator>) {
+            if (new_size > capacity() and is_zero_bits(value)) {
+                grow_to(new_size, ReallocateZeroed());
+                m_size = new_size;
+                return;
+            }
+        }
+        auto old_size = size();
+        auto fill_value = value;
+        if (capacity() < new_size) {
+            grow_to(new_size);
+        }
+        m_size = new_size;
+        if (new_size > old_size) {
+            std::ranges::fill(data() + old_size, data() + new_size, fill_value);
+        }
+    }
+
+    constexpr void resize(
+        size_type new_size, const value_type& value, Stream
+    ) requires std::is_trivially_copyable_v<T> {
+        if constexpr (ZeroingAllocator<Allocator>) {
+            if (new_size > capacity() and is_zero_bits(value)) {
+                grow_to(new_size, ReallocateZeroed());
+                m_size = new_size;
+                return;
+            }
+        }
         auto old_size = size();
-        resize(new_size);
+        auto fill_value = value;
+        if (capacity() < new_size) {
+            grow_to(new_size);
+        }
+        m_size = new_size;
         if (new_size > old_size) {
-            std::ranges::fill(data() + old_size, data() + new_size, value);
+            stream_fill(data() + old_size, new_size - old_size, fill_value);
         }
     }
 
@@ -706,8 +1617,10 @@ public:
         const_iterator first, const_iterator last
     ) noexcept {
         assert(begin() <= first and first <= last and last <= end());
+        destroy_elements(data(), data() + std::ranges::distance(cbegin(), first));
+        destroy_elements(data() + std::ranges::distance(cbegin(), last), data() + size());
         if (first != begin()) {
-            std::ranges::copy(first, last, begin());
+            move_elements(std::to_address(first), last - first, data());
         }
         m_size = std::ranges::distance(first, last);
     }
@@ -721,21 +1634,65 @@ public:
 
     constexpr void truncate(size_type new_size) noexcept {
         assert(new_size <= size());
+        destroy_elements(data() + new_size, data() + size());
         m_size = new_size;
     }
 
-    constexpr void fit(size_type new_size) {
+    // Leaves any new elements uninitialized
+    constexpr void fit(size_type new_size)
+        requires std::is_trivially_copyable_v<T>
+    {
         if (capacity() < new_size) {
-            grow_to(new_size, [] (auto, auto, auto) {});
+            grow_to(new_size, ReallocateDiscard());
         }
         m_size = new_size;
     }
 
     constexpr bool data_is_inlined() const noexcept {
-        return data() == inline_data();
+        if constexpr (HasInlineStorage) {
+            return not m_data and capacity();
+        } else {
+            return false;
+        }
     };
 
 protected:
+    static constexpr void default_construct(
+        value_type* first, value_type* last
+    ) {
+        if constexpr (not std::is_trivially_default_constructible_v<value_type>) {
+            std::ranges::uninitialized_default_construct(first, last);
+        }
+    }
+
+    // Relocating elements with memcpy does not end their lifetime, only
+    // leaving the vector does
+    static constexpr void destroy_elements(
+        value_type* first, value_type* last
+    ) noexcept {
+        if constexpr (not std::is_trivially_destructible_v<value_type>) {
+            std::destroy(first, last);
+        }
+    }
+
+    constexpr const_pointer data_ptr() const noexcept {
+        if constexpr (HasInlineStorage) {
+            if (data_is_inlined()) {
+                return inline_data();
+            }
+        }
+        return m_data;
+    }
+
+    constexpr pointer data_ptr() noexcept {
+        if constexpr (HasInlineStorage) {
+            if (data_is_inlined()) {
+                return inline_data();
+            }
+        }
+        return m_data;
+    }
+
     constexpr Allocator& allocator() noexcept {
         return *this;
     }
@@ -748,46 +1705,148 @@ protected:
             lhs.get_allocator() == rhs.get_allocator();
     }
 
-    constexpr pointer allocate(size_t new_capacity) {
-        return AllocTraits::allocate(allocator(), new_capacity);
+    constexpr auto allocate(size_t new_capacity) {
+        return TrivialVectorNameSpace::allocate_at_least(
+            allocator(), new_capacity);
     }
 
     constexpr void deallocate() noexcept {
-        if (not data_is_inlined()) {
-            AllocTraits::deallocate(allocator(), data(), capacity());
+        if (m_data) {
+            AllocTraits::deallocate(allocator(), m_data, capacity());
         }
     }
 
     struct ReallocateWithCopy {
         void operator() (auto src, auto cnt, auto dst) {
-            std::ranges::copy_n(src, cnt, dst);
+            copy_elements(src, cnt, std::to_address(dst));
         }
     };
 
+    struct ReallocateDiscard {
+        void operator() (auto, auto, auto) {}
+    };
+
+    // Copies the prefix into zero-filled memory, so everything after it
+    // reads as zeros
+    struct ReallocateZeroed: ReallocateWithCopy {};
+
+    constexpr bool expand_in_place(size_t new_capacity) {
+        assert(not data_is_inlined());
+        if (new_capacity <= capacity()) {
+            return false;
+        }
+        if constexpr (ExpandableAtLeastAllocator<Allocator>) {
+            size_type count = allocator().try_expand_at_least(
+                m_data, capacity(), new_capacity);
+            if (count) {
+                assert(count >= new_capacity);
+                m_capacity = count;
+                return true;
+            }
+        } else if constexpr (ExpandableAllocator<Allocator>) {
+            if (allocator().try_expand(m_data, capacity(), new_capacity)) {
+                m_capacity = new_capacity;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Expands the buffer to fit new_size elements without moving it,
+    // following the growth policy where the allocator lets it
+    constexpr bool grow_in_place(size_t new_size) {
+        if constexpr (
+            ExpandableAtLeastAllocator<Allocator> or
+            ExpandableAllocator<Allocator>
+        ) {
+            if (not capacity() or data_is_inlined()) {
+                return false;
+            }
+            auto new_capacity = std::min<size_t>(
+                grow_capacity(capacity()), max_size());
+            if (new_size < new_capacity) {
+                try {
+                    if (expand_in_place(new_capacity)) {
+                        return true;
+                    }
+                } catch (const std::bad_alloc&) {}
+            }
+            return expand_in_place(new_size);
+        } else {
+            return false;
+        }
+    }
+
+    constexpr bool reallocate_in_place(size_t new_capacity) {
+        if (expand_in_place(new_capacity)) {
+            return true;
+        }
+        if constexpr (ReallocatableAtLeastAllocator<Allocator>) {
+            auto [new_data, count] = allocator().reallocate_at_least(
+                m_data, capacity(), new_capacity);
+            assert(count >= new_capacity);
+            m_data = new_data;
+            m_capacity = count;
+            return true;
+        } else if constexpr (ReallocatableAllocator<Allocator>) {
+            m_data = allocator().reallocate(m_data, capacity(), new_capacity);
+            m_capacity = new_capacity;
+            return true;
+        }
+        return false;
+    }
+
     constexpr void reallocate(
         size_t new_capacity, size_t from_size, auto reallocate_strategy
     ) {
         assert(new_capacity <= max_size());
-        auto new_data = allocate(new_capacity);
+        using S = decltype(reallocate_strategy);
+        // Only a plain prefix copy can be delegated to the allocator,
+        // other strategies need both buffers at once
+        if constexpr (std::same_as<S, ReallocateWithCopy>) {
+            assert(from_size <= capacity());
+            bool in_place =
+                capacity() and not data_is_inlined() and
+                reallocate_in_place(new_capacity);
+            if (in_place) {
+                return;
+            }
+        } else if constexpr (std::same_as<S, ReallocateDiscard>) {
+            bool in_place =
+                capacity() and not data_is_inlined() and
+                expand_in_place(new_capacity);
+            if (in_place) {
+                return;
+            }
+        }
+        auto [new_data, count] = [&] {
+            if constexpr (std::same_as<S, ReallocateZeroed>) {
+                return allocate_zeroed_at_least(allocator(), new_capacity);
+            } else {
+                return allocate(new_capacity);
+            }
+        } ();
         reallocate_strategy(data(), from_size, new_data);
         deallocate();
         m_data = new_data;
-        m_capacity = new_capacity;
+        m_capacity = count;
     }
 
     constexpr void reallocate(size_t new_capacity) {
         reallocate(new_capacity, size(), ReallocateWithCopy());
     }
 
-    static constexpr size_type grow_capacity(size_type capacity) noexcept {
-        return std::max<size_type>(2 * capacity, 1);
+    static constexpr size_t grow_capacity(size_t capacity) noexcept {
+        return GrowthPolicy::grow_capacity(capacity, sizeof(value_type));
     }
 
     template <typename S = ReallocateWithCopy>
     constexpr void grow(
-        size_type new_size, size_type from_size, S reallocate_strategy = S()
+        size_t new_size, size_type from_size, S reallocate_strategy = S()
     ) {
-        auto new_capacity = grow_capacity(capacity());
+        length_check(0, new_size);
+        auto new_capacity = std::min<size_t>(
+            grow_capacity(capacity()), max_size());
         if (new_size < new_capacity) {
             try {
                 reallocate(new_capacity, from_size, reallocate_strategy);
@@ -798,7 +1857,7 @@ protected:
     }
 
     template <typename S = ReallocateWithCopy>
-    constexpr void grow_to(size_type new_size, S reallocate_strategy = S()) {
+    constexpr void grow_to(size_t new_size, S reallocate_strategy = S()) {
         grow(new_size, size(), std::move(reallocate_strategy));
     }
 
@@ -820,7 +1879,15 @@ struct InlineStorage {
 
     static constexpr unsigned Capacity      = BufferSize / sizeof(T);
 
-    std::array<T, Capacity> m_storage;
+    // A union member is neither constructed nor destroyed, so T need not
+    // be trivially default constructible or destructible. The vector
+    // destroys the elements it holds.
+    union {
+        alignas(AlignSize) std::array<T, Capacity> m_storage;
+    };
+
+    constexpr InlineStorage() noexcept {}
+    constexpr ~InlineStorage() {}
 
     constexpr const T* addr() const noexcept { return m_storage.data(); }
     constexpr T* addr() noexcept { return m_storage.data(); }
@@ -835,15 +1902,21 @@ struct InlineStorage<T, 0, MinAlignSize> {
 template<
     typename T,
     unsigned InlineCapacity = DefaultInlineCapacity<T>,
-    typename Allocator = std::allocator<T>
-> requires InlineTrivialVectorConcept<T, InlineCapacity, Allocator>
+    typename Allocator = std::allocator<T>,
+    typename GrowthPolicy = DoubleGrowth
+> requires InlineTrivialVectorConcept<T, InlineCapacity, Allocator, GrowthPolicy>
 class InlineTrivialVector:
-    public TrivialVectorHeader<T, Allocator>,
-    private InlineStorage<T, InlineCapacity, alignof(TrivialVectorHeader<T, Allocator>)>
+    public TrivialVectorHeader<T, Allocator, GrowthPolicy, InlineCapacity != 0>,
+    private InlineStorage<
+        T, InlineCapacity,
+        std::max(
+            alignof(TrivialVectorHeader<T, Allocator, GrowthPolicy, InlineCapacity != 0>),
+            TrivialVectorHeader<T, Allocator, GrowthPolicy, InlineCapacity != 0>::alignment)>
 {
-    using Base = TrivialVectorHeader<T, Allocator>;
+    using Base = TrivialVectorHeader<T, Allocator, GrowthPolicy, InlineCapacity != 0>;
     friend Base;
-    using Storage = InlineStorage<T, InlineCapacity, alignof(Base)>;
+    using Storage = InlineStorage<
+        T, InlineCapacity, std::max(alignof(Base), Base::alignment)>;
     using typename Base::AllocTraits;
     using Base::m_data;
     using Base::m_capacity;
@@ -860,6 +1933,7 @@ class InlineTrivialVector:
 public:
     using typename Base::value_type;
     using typename Base::allocator_type;
+    using typename Base::growth_policy;
     using typename Base::size_type;
     using typename Base::difference_type;
     using typename Base::reference;
@@ -877,36 +1951,42 @@ public:
         InlineTrivialVector(Allocator()) {}
 
     constexpr explicit InlineTrivialVector(Allocator alloc) noexcept:
-        Base{std::move(alloc), inline_data(), max_inline_size()} {}
+        Base{std::move(alloc), nullptr, max_inline_size()} {}
 
     constexpr explicit InlineTrivialVector(size_type size)
-        requires std::default_initializable<Allocator>:
+        requires std::default_initializable<Allocator> and
+            std::default_initializable<value_type>:
         InlineTrivialVector(size, Allocator()) {}
 
-    constexpr InlineTrivialVector(size_type size, Allocator alloc):
+    constexpr InlineTrivialVector(size_type size, Allocator alloc)
+        requires std::default_initializable<value_type>:
         InlineTrivialVector(std::move(alloc))
     {
-        this->fit(size);
+        this->resize(size);
     }
 
     constexpr InlineTrivialVector(size_type count, const value_type& value)
-        requires std::default_initializable<Allocator>:
+        requires std::default_initializable<Allocator> and
+            std::is_trivially_copyable_v<T>:
         InlineTrivialVector(count, value, Allocator()) {}
 
-    constexpr InlineTrivialVector(size_type count, const value_type& value, Allocator alloc):
-        InlineTrivialVector(count, std::move(alloc))
+    constexpr InlineTrivialVector(size_type count, const value_type& value, Allocator alloc)
+        requires std::is_trivially_copyable_v<T>:
+        InlineTrivialVector(std::move(alloc))
     {
-        std::ranges::fill(*this, value);
+        this->assign(count, value);
     }
 
     template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
-        requires std::convertible_to<std::iter_value_t<Iter>, value_type>
+        requires std::convertible_to<std::iter_value_t<Iter>, value_type> and
+            std::is_trivially_copyable_v<T>
     constexpr InlineTrivialVector(Iter first, Sent last)
         requires std::default_initializable<Allocator>:
         InlineTrivialVector(first, last, Allocator()) {}
 
     template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
-        requires std::convertible_to<std::iter_value_t<Iter>, value_type>
+        requires std::convertible_to<std::iter_value_t<Iter>, value_type> and
+            std::is_trivially_copyable_v<T>
     constexpr InlineTrivialVector(Iter first, Sent last, Allocator alloc):
         InlineTrivialVector{std::move(alloc)}
     {
@@ -914,20 +1994,23 @@ public:
     }
 
     template<std::ranges::input_range R>
-        requires std::convertible_to<std::ranges::range_value_t<R>, value_type>
+        requires std::convertible_to<std::ranges::range_value_t<R>, value_type> and
+            std::is_trivially_copyable_v<T>
     constexpr explicit InlineTrivialVector(R&& r)
         requires std::default_initializable<Allocator>:
         InlineTrivialVector(std::forward<R>(r), Allocator()) {}
 
     template<std::ranges::input_range R>
-        requires std::convertible_to<std::ranges::range_value_t<R>, value_type>
+        requires std::convertible_to<std::ranges::range_value_t<R>, value_type> and
+            std::is_trivially_copyable_v<T>
     constexpr InlineTrivialVector(R&& r, Allocator alloc):
         InlineTrivialVector(std::move(alloc))
     {
         this->assign(std::forward<R>(r));
     }
 
-    constexpr InlineTrivialVector(const InlineTrivialVector& other):
+    constexpr InlineTrivialVector(const InlineTrivialVector& other)
+        requires std::is_trivially_copyable_v<T>:
         InlineTrivialVector(
             AllocTraits::select_on_container_copy_construction(
                 other.get_allocator()))
@@ -941,11 +2024,11 @@ public:
         bool can_move = not other.data_is_inlined();
         if (can_move) {
             m_data =
-                std::exchange(other.m_data, other.inline_data());
+                std::exchange(other.m_data, nullptr);
             m_capacity =
                 std::exchange(other.m_capacity, other.max_inline_size());
         } else {
-            std::ranges::copy_n(other.data(), max_inline_size(), this->data());
+            copy_elements(other.data(), other.size(), this->data());
         }
         m_size =
             std::exchange(other.m_size, 0);
@@ -953,7 +2036,8 @@ public:
 
     constexpr InlineTrivialVector(
         std::initializer_list<value_type> init
-    ): InlineTrivialVector(init.begin(), init.end()) {}
+    ) requires std::is_trivially_copyable_v<T>:
+        InlineTrivialVector(init.begin(), init.end()) {}
 
     constexpr InlineTrivialVector(
         pointer ptr, size_type capacity, size_type size
@@ -963,13 +2047,22 @@ public:
 
     constexpr InlineTrivialVector(
         pointer ptr, size_type capacity, size_type size, Allocator alloc
-    ) noexcept: Base(std::move(alloc), ptr, capacity, size) {}
+    ) noexcept: Base(std::move(alloc), ptr, capacity, size) {
+        assert(ptr or not capacity);
+    }
 
-    constexpr ~InlineTrivialVector() = default;
+    constexpr ~InlineTrivialVector() {
+        Base::destroy_elements(this->data(), this->data() + this->size());
+    }
 
+    // A defaulted one would also copy the inline storage, over the elements
+    // that the header has just assigned
     constexpr InlineTrivialVector& operator=(
         const InlineTrivialVector& other
-    ) = default;
+    ) requires std::is_trivially_copyable_v<T> {
+        Base::operator=(other);
+        return *this;
+    }
 
     constexpr InlineTrivialVector& operator=(
         InlineTrivialVector&& other
@@ -990,6 +2083,7 @@ public:
             }
         } ();
 
+        this->clear();
         if (can_move) {
             this->deallocate();
             if constexpr (propagate) {
@@ -998,7 +2092,7 @@ public:
             m_data      = other.m_data;
             m_capacity  = other.m_capacity;
             m_size      = other.m_size;
-            other.m_data        = other.inline_data();
+            other.m_data        = nullptr;
             other.m_capacity    = other.max_inline_size();
             other.m_size        = 0;
         } else {
@@ -1006,16 +2100,16 @@ public:
                 // Other's data is stored inline
                 this->deallocate();
                 this->allocator() = std::move(other.allocator());
-                m_data = inline_data();
+                m_data = nullptr;
                 m_capacity = max_inline_size();
-                std::ranges::copy(other, this->data());
-                m_size = other.size();
-            } else {
+            } else if (this->capacity() < other.size()) {
                 // Either other's data is stored inline
                 // or other's allocator differs from this
-                this->assign(other);
+                this->grow_to(other.size(), typename Base::ReallocateDiscard());
             }
-            other.clear();
+            // The elements are relocated, so other must not destroy them
+            copy_elements(other.data(), other.size(), this->data());
+            m_size = std::exchange(other.m_size, 0);
         }
 
         return *this;
@@ -1031,8 +2125,8 @@ public:
         ) noexcept {
             assert(inl.data_is_inlined());
             assert(not heap.data_is_inlined());
-            std::ranges::copy_n(inl.data(), max_inline_size(), heap.inline_data());
-            inl.m_data = std::exchange(heap.m_data, heap.inline_data());
+            copy_elements(inl.data(), inl.size(), heap.inline_data());
+            inl.m_data = std::exchange(heap.m_data, nullptr);
             inl.m_capacity = std::exchange(heap.m_capacity, heap.max_inline_size());
         };
 
@@ -1040,11 +2134,15 @@ public:
             std::ranges::swap(m_data, other.m_data);
             std::ranges::swap(m_capacity, other.m_capacity);
         } else if (this->data_is_inlined() and other.data_is_inlined()) {
-            constexpr auto swap_size = max_inline_size();
-            std::array<T, swap_size> tmp;
-            std::ranges::copy_n(this->data(), swap_size, tmp.data());
-            std::ranges::copy_n(other.data(), swap_size, this->data());
-            std::ranges::copy_n(tmp.data(), swap_size, other.data());
+            auto swap_size = std::min(this->size(), other.size());
+            std::swap_ranges(
+                this->data(), this->data() + swap_size, other.data());
+            // The rest of the longer one is relocated to the shorter one
+            auto& longer = this->size() > other.size() ? *this : other;
+            auto& shorter = this->size() > other.size() ? other : *this;
+            copy_elements(
+                longer.data() + swap_size, longer.size() - swap_size,
+                shorter.data() + swap_size);
         } else if (this->data_is_inlined()) {
             inline_heap_swap(*this, other);
         } else {
@@ -1066,10 +2164,10 @@ public:
         if (not this->data_is_inlined()) {
             new_capacity = std::max(new_capacity, this->size());
             if (new_capacity <= max_inline_size()) {
+                copy_elements(this->data(), this->size(), this->inline_data());
                 this->deallocate();
-                m_data = this->inline_data();
+                m_data = nullptr;
                 m_capacity = max_inline_size();
-                std::ranges::copy(*this, this->data());
             } else if (new_capacity < this->capacity()) {
                 try {
                     this->reallocate(new_capacity);
@@ -1093,7 +2191,7 @@ public:
     constexpr Allocation release() noexcept {
         assert(not this->data_is_inlined());
         return {
-            .ptr = std::exchange(m_data, this->inline_data()),
+            .ptr = std::exchange(m_data, nullptr),
             .capacity = std::exchange(m_capacity, max_inline_size()),
             .size = std::exchange(m_size, 0),
             .allocator = std::move(this->allocator()),
@@ -1126,62 +2224,160 @@ InlineTrivialVector(R&&, Allocator) ->
         DefaultInlineCapacity<std::ranges::range_value_t<R>>,
         Allocator>;
 
+// Inline data is found through the null data pointer rather than a pointer
+// into the object, so only the allocator can tie a vector to its address.
+// Stateless allocators such as std::allocator can't. Vectors of such
+// vectors then grow, insert and erase with memcpy and memmove.
+INLINE_TRIVIAL_VECTOR_TEMPLATE
+struct is_trivially_relocatable<INLINE_TRIVIAL_VECTOR>: std::bool_constant<
+    std::is_empty_v<Allocator> or is_trivially_relocatable_v<Allocator>> {};
+
 INLINE_TRIVIAL_VECTOR_TEMPLATE
 void swap(INLINE_TRIVIAL_VECTOR& lhs, INLINE_TRIVIAL_VECTOR& rhs) noexcept {
     lhs.swap(rhs);
 }
 
-TRIVIAL_VECTOR_HEADER_TEMPLATE
-constexpr bool operator==(
-    const TRIVIAL_VECTOR_HEADER& lhs, const TRIVIAL_VECTOR_HEADER& rhs
+// Vectors with and without inline storage compare with each other
+template<
+    typename T, typename Allocator, typename GrowthPolicy,
+    bool LhsInline, bool RhsInline
+> constexpr bool operator==(
+    const TrivialVectorHeader<T, Allocator, GrowthPolicy, LhsInline>& lhs,
+    const TrivialVectorHeader<T, Allocator, GrowthPolicy, RhsInline>& rhs
 ) noexcept {
-    return std::ranges::equal(lhs, rhs);
+    return
+        lhs.size() == rhs.size() and
+        equal_elements(lhs.data(), rhs.data(), lhs.size());
 }
 
-TRIVIAL_VECTOR_HEADER_TEMPLATE
-constexpr auto operator<=>(
-    const TRIVIAL_VECTOR_HEADER& lhs, const TRIVIAL_VECTOR_HEADER& rhs
+template<
+    typename T, typename Allocator, typename GrowthPolicy,
+    bool LhsInline, bool RhsInline
+> constexpr auto operator<=>(
+    const TrivialVectorHeader<T, Allocator, GrowthPolicy, LhsInline>& lhs,
+    const TrivialVectorHeader<T, Allocator, GrowthPolicy, RhsInline>& rhs
 ) noexcept {
-    return std::lexicographical_compare_three_way(
-        lhs.begin(), lhs.end(),
-        rhs.begin(), rhs.end());
+    return compare_elements(lhs.data(), lhs.size(), rhs.data(), rhs.size());
 }
 
 TRIVIAL_VECTOR_HEADER_TEMPLATE
 constexpr auto TRIVIAL_VECTOR_HEADER::inline_data() const noexcept -> const T* {
-    return static_cast<const InlineTrivialVector<T, 1, Allocator>*>(this)->inline_data();
+    return static_cast<const InlineTrivialVector<T, 1, Allocator, GrowthPolicy>*>(this)->inline_data();
 }
 
 TRIVIAL_VECTOR_HEADER_TEMPLATE
 constexpr auto TRIVIAL_VECTOR_HEADER::inline_data() noexcept -> T* {
-    return static_cast<InlineTrivialVector<T, 1, Allocator>*>(this)->inline_data();
+    return static_cast<InlineTrivialVector<T, 1, Allocator, GrowthPolicy>*>(this)->inline_data();
 }
 
 TRIVIAL_VECTOR_HEADER_TEMPLATE
 constexpr TRIVIAL_VECTOR_HEADER::size_type erase(
     TRIVIAL_VECTOR_HEADER& vec, const T& value
 ) noexcept {
-    auto count = std::ranges::size(
-        std::ranges::remove(vec, value)
-    );
-    vec.truncate(vec.size() - count);
+    auto new_size = remove_equal(vec.data(), vec.size(), value);
+    auto count = vec.size() - new_size;
+    vec.truncate(new_size);
     return count;
 }
 
 template<
-    typename T, typename Allocator,
+    typename T, typename Allocator, typename GrowthPolicy, bool HasInlineStorage,
     std::indirect_unary_predicate<
         typename TRIVIAL_VECTOR_HEADER::iterator> Pred
 > constexpr TRIVIAL_VECTOR_HEADER::size_type erase_if(
     TRIVIAL_VECTOR_HEADER& vec, Pred pred
 ) noexcept {
-    auto count = std::ranges::size(
-        std::ranges::remove_if(vec, std::move(pred))
-    );
-    vec.truncate(vec.size() - count);
+    size_t new_size;
+    if constexpr (
+        sizeof(T) <= 2 * sizeof(void*) and std::is_trivially_copyable_v<T>
+    ) {
+        // Copy every element and only advance past the ones that stay, so
+        // that unpredictable predicates do not cost a mispredict each
+        auto data = vec.data();
+        new_size = 0;
+        for (size_t i = 0; i < vec.size(); i++) {
+            bool remove = std::invoke(pred, data[i]);
+            data[new_size] = data[i];
+            new_size += not remove;
+        }
+    } else {
+        new_size = vec.size() - std::ranges::size(
+            std::ranges::remove_if(vec, std::move(pred))
+        );
+    }
+    auto count = vec.size() - new_size;
+    vec.truncate(new_size);
+    return count;
+}
+
+inline constexpr size_t EraseBatchSize = 64;
+
+// Calls pred with consecutive spans of up to EraseBatchSize elements and
+// erases the elements whose bit is set in the mask it returns, bit i
+// standing for element i of the span. The survivors are packed with vector
+// compress instructions where the target has them.
+template<
+    typename T, typename Allocator, typename GrowthPolicy, bool HasInlineStorage,
+    std::invocable<std::span<const T>> Pred
+> requires std::convertible_to<
+    std::invoke_result_t<Pred&, std::span<const T>>, uint64_t> and
+    std::is_trivially_copyable_v<T>
+constexpr TRIVIAL_VECTOR_HEADER::size_type erase_if_batch(
+    TRIVIAL_VECTOR_HEADER& vec, Pred pred
+) noexcept {
+    auto data = vec.data();
+    auto out = data;
+    for (size_t i = 0; i < vec.size(); i += EraseBatchSize) {
+        auto count = std::min<size_t>(vec.size() - i, EraseBatchSize);
+        uint64_t remove = std::invoke(pred, std::span<const T>{data + i, count});
+        out = compress_block(data + i, count, ~remove, out);
+    }
+    auto count = vec.size() - (out - data);
+    vec.truncate(out - data);
     return count;
 }
 
+// A vector that no longer changes, stored together with its hash, so that
+// using it as a hash map key hashes the contents only once
+template<typename Vec> requires requires(const Vec& vec) {
+    { vec.hash() } -> std::same_as<size_t>;
+}
+class FrozenVector {
+    Vec     m_vec;
+    size_t  m_hash;
+
+public:
+    explicit FrozenVector(Vec vec) noexcept(
+        std::is_nothrow_move_constructible_v<Vec>
+    ): m_vec(std::move(vec)), m_hash(m_vec.hash()) {}
+
+    const Vec& get() const noexcept {
+        return m_vec;
+    }
+
+    const Vec& operator*() const noexcept {
+        return m_vec;
+    }
+
+    const Vec* operator->() const noexcept {
+        return &m_vec;
+    }
+
+    size_t hash() const noexcept {
+        return m_hash;
+    }
+
+    friend bool operator==(
+        const FrozenVector& lhs, const FrozenVector& rhs
+    ) noexcept {
+        return lhs.m_hash == rhs.m_hash and lhs.m_vec == rhs.m_vec;
+    }
+};
+
+template<typename Vec>
+struct is_trivially_relocatable<FrozenVector<Vec>>:
+    is_trivially_relocatable<Vec> {};
+
 #undef TRIVIAL_VECTOR_HEADER_TEMPLATE
 #undef TRIVIAL_VECTOR_HEADER
 #undef INLINE_TRIVIAL_VECTOR_TEMPLATE
@@ -1190,8 +2386,78 @@ template<
 
 namespace Attractadore {
 using TrivialVectorNameSpace::InlineTrivialVector;
+using TrivialVectorNameSpace::AllocationResult;
+using TrivialVectorNameSpace::AlignedAllocator;
+using TrivialVectorNameSpace::Populate;
+using TrivialVectorNameSpace::populate;
+using TrivialVectorNameSpace::Stream;
+using TrivialVectorNameSpace::stream;
+using TrivialVectorNameSpace::StreamThreshold;
+using TrivialVectorNameSpace::MallocAllocator;
+using TrivialVectorNameSpace::CompactAllocator;
+using TrivialVectorNameSpace::GeometricGrowth;
+using TrivialVectorNameSpace::DoubleGrowth;
+using TrivialVectorNameSpace::HalfGrowth;
+using TrivialVectorNameSpace::FixedGrowth;
+using TrivialVectorNameSpace::PageGrowth;
+using TrivialVectorNameSpace::is_trivially_relocatable;
+using TrivialVectorNameSpace::is_trivially_relocatable_v;
+using TrivialVectorNameSpace::EraseBatchSize;
+using TrivialVectorNameSpace::FrozenVector;
+template<
+    typename T,
+    typename Allocator = std::allocator<T>,
+    typename GrowthPolicy = DoubleGrowth
+> using TrivialVector = InlineTrivialVector<T, 0, Allocator, GrowthPolicy>;
+
+template<
+    typename T,
+    size_t Alignment,
+    unsigned InlineCapacity = TrivialVectorNameSpace::DefaultInlineCapacity<T>,
+    typename GrowthPolicy = DoubleGrowth
+> using AlignedInlineTrivialVector = InlineTrivialVector<
+    T, InlineCapacity, AlignedAllocator<T, Alignment>, GrowthPolicy>;
+
+template<
+    typename T,
+    size_t Alignment,
+    typename GrowthPolicy = DoubleGrowth
+> using AlignedTrivialVector =
+    TrivialVector<T, AlignedAllocator<T, Alignment>, GrowthPolicy>;
+
+template<
+    typename T,
+    unsigned InlineCapacity = TrivialVectorNameSpace::DefaultInlineCapacity<T>,
+    typename Allocator = std::allocator<T>,
+    typename GrowthPolicy = DoubleGrowth
+> using CompactInlineTrivialVector = InlineTrivialVector<
+    T, InlineCapacity, CompactAllocator<Allocator>, GrowthPolicy>;
+
 template<
     typename T,
-    typename Allocator = std::allocator<T>
-> using TrivialVector = InlineTrivialVector<T, 0, Allocator>;
+    typename Allocator = std::allocator<T>,
+    typename GrowthPolicy = DoubleGrowth
+> using CompactTrivialVector =
+    TrivialVector<T, CompactAllocator<Allocator>, GrowthPolicy>;
 }
+
+template<
+    typename T, unsigned InlineCapacity, typename Allocator, typename GrowthPolicy
+> requires Attractadore::TrivialVectorNameSpace::ElementHashable<T>
+struct std::hash<
+    Attractadore::InlineTrivialVector<T, InlineCapacity, Allocator, GrowthPolicy>
+> {
+    size_t operator()(
+        const Attractadore::InlineTrivialVector<
+            T, InlineCapacity, Allocator, GrowthPolicy>& vec
+    ) const noexcept {
+        return vec.hash();
+    }
+};
+
+template<typename Vec>
+struct std::hash<Attractadore::FrozenVector<Vec>> {
+    size_t operator()(const Attractadore::FrozenVector<Vec>& vec) const noexcept {
+        return vec.hash();
+    }
+};
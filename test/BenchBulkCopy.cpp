@@ -0,0 +1,62 @@
+#include "Attractadore/TrivialVector.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <vector>
+
+using Attractadore::TrivialVector;
+
+template<typename Vec>
+void InsertFront(benchmark::State& state)
+{
+    size_t size = state.range(0);
+    std::vector<int> src(16);
+    std::iota(src.begin(), src.end(), 0);
+    Vec vec(size);
+    vec.reserve(size + src.size());
+    for (auto _: state) {
+        vec.insert(vec.begin(), src.begin(), src.end());
+        vec.erase(vec.end() - src.size(), vec.end());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * size * sizeof(int));
+}
+
+template<typename Vec>
+void EraseFront(benchmark::State& state)
+{
+    size_t size = state.range(0);
+    Vec vec(size);
+    for (auto _: state) {
+        vec.erase(vec.begin(), vec.begin() + 16);
+        vec.resize(size);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * size * sizeof(int));
+}
+
+template<typename Vec>
+void AssignRange(benchmark::State& state)
+{
+    size_t size = state.range(0);
+    std::vector<int> src(size);
+    std::iota(src.begin(), src.end(), 0);
+    Vec vec;
+    vec.reserve(size);
+    for (auto _: state) {
+        vec.assign(src.begin(), src.end());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * size * sizeof(int));
+}
+
+#define BULK_COPY_BENCHMARK(func) \
+    BENCHMARK_TEMPLATE(func, std::vector<int>)->Range(1 << 8, 1 << 20); \
+    BENCHMARK_TEMPLATE(func, TrivialVector<int>)->Range(1 << 8, 1 << 20);
+
+BULK_COPY_BENCHMARK(InsertFront);
+BULK_COPY_BENCHMARK(EraseFront);
+BULK_COPY_BENCHMARK(AssignRange);
+
+BENCHMARK_MAIN();
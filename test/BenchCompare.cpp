@@ -0,0 +1,45 @@
+#include "Attractadore/TrivialVector.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using Attractadore::TrivialVector;
+
+// Equal vectors, so that every comparison scans all of both, and vectors
+// that differ in the last element
+template<typename Vec>
+void Equal(benchmark::State& state)
+{
+    Vec lhs(state.range(0), 7);
+    auto rhs = lhs;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(lhs);
+        benchmark::DoNotOptimize(lhs == rhs);
+    }
+    state.SetBytesProcessed(state.iterations() * lhs.size() * sizeof(lhs[0]));
+}
+
+template<typename Vec>
+void ThreeWay(benchmark::State& state)
+{
+    Vec lhs(state.range(0), 7);
+    auto rhs = lhs;
+    rhs.back() = 8;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(lhs);
+        benchmark::DoNotOptimize(lhs <=> rhs);
+    }
+    state.SetBytesProcessed(state.iterations() * lhs.size() * sizeof(lhs[0]));
+}
+
+#define COMPARE_BENCHMARK(func, T) \
+    BENCHMARK_TEMPLATE(func, std::vector<T>)->Range(16, 1 << 16); \
+    BENCHMARK_TEMPLATE(func, TrivialVector<T>)->Range(16, 1 << 16);
+
+COMPARE_BENCHMARK(Equal, uint8_t);
+COMPARE_BENCHMARK(Equal, uint32_t);
+COMPARE_BENCHMARK(ThreeWay, uint8_t);
+COMPARE_BENCHMARK(ThreeWay, uint32_t);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,86 @@
+#include "Attractadore/TrivialVector.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using Attractadore::TrivialVector;
+
+// Random values, so that the predicates below are true for about half of
+// the elements in no particular pattern
+template<typename Vec>
+Vec make_vector(size_t size) {
+    std::mt19937 gen{size};
+    Vec vec(size);
+    for (auto& v: vec) {
+        v = gen();
+    }
+    return vec;
+}
+
+constexpr bool is_odd(uint32_t v) noexcept {
+    return v & 1;
+}
+
+template<typename Vec>
+void EraseIf(benchmark::State& state)
+{
+    auto src = make_vector<Vec>(state.range(0));
+    Vec vec;
+    for (auto _: state) {
+        state.PauseTiming();
+        vec = src;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(erase_if(vec, is_odd));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+void EraseIfBatch(benchmark::State& state)
+{
+    auto src = make_vector<TrivialVector<uint32_t>>(state.range(0));
+    TrivialVector<uint32_t> vec;
+    for (auto _: state) {
+        state.PauseTiming();
+        vec = src;
+        state.ResumeTiming();
+        auto cnt = erase_if_batch(vec, [] (std::span<const uint32_t> batch) {
+            uint64_t mask = 0;
+            for (size_t i = 0; i < batch.size(); i++) {
+                mask |= uint64_t(is_odd(batch[i])) << i;
+            }
+            return mask;
+        });
+        benchmark::DoNotOptimize(cnt);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+template<typename Vec>
+void EraseValue(benchmark::State& state)
+{
+    auto src = make_vector<Vec>(state.range(0));
+    for (auto& v: src) {
+        v &= 1;
+    }
+    Vec vec;
+    for (auto _: state) {
+        state.PauseTiming();
+        vec = src;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(erase(vec, 1u));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+BENCHMARK_TEMPLATE(EraseIf, std::vector<uint32_t>)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(EraseIf, TrivialVector<uint32_t>)->Range(1 << 10, 1 << 20);
+BENCHMARK(EraseIfBatch)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(EraseValue, std::vector<uint32_t>)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(EraseValue, TrivialVector<uint32_t>)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,83 @@
+#include "Attractadore/TrivialVector.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using Attractadore::TrivialVector;
+
+// Erases state.range(1) random elements out of state.range(0)
+struct Victims {
+    std::vector<size_t>     indices;
+    std::vector<uint64_t>   mask;
+
+    Victims(size_t size, size_t count): mask((size + 63) / 64) {
+        std::mt19937_64 gen{count};
+        while (indices.size() < count) {
+            auto idx = gen() % size;
+            if (not (mask[idx / 64] >> (idx % 64) & 1)) {
+                mask[idx / 64] |= uint64_t(1) << (idx % 64);
+                indices.push_back(idx);
+            }
+        }
+        std::ranges::sort(indices);
+    }
+};
+
+void EraseLoop(benchmark::State& state)
+{
+    TrivialVector<uint64_t> src(state.range(0));
+    Victims victims(state.range(0), state.range(1));
+    TrivialVector<uint64_t> vec;
+    for (auto _: state) {
+        state.PauseTiming();
+        vec = src;
+        state.ResumeTiming();
+        // Back to front, so that the indices stay valid
+        for (auto idx: victims.indices | std::views::reverse) {
+            vec.erase(vec.begin() + idx);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+void EraseIndices(benchmark::State& state)
+{
+    TrivialVector<uint64_t> src(state.range(0));
+    Victims victims(state.range(0), state.range(1));
+    TrivialVector<uint64_t> vec;
+    for (auto _: state) {
+        state.PauseTiming();
+        vec = src;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(vec.erase_indices(victims.indices));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+void EraseMask(benchmark::State& state)
+{
+    TrivialVector<uint64_t> src(state.range(0));
+    Victims victims(state.range(0), state.range(1));
+    TrivialVector<uint64_t> vec;
+    for (auto _: state) {
+        state.PauseTiming();
+        vec = src;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(vec.erase_mask(victims.mask));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+#define ERASE_BENCHMARK(func) \
+    BENCHMARK(func)->ArgsProduct({{100000}, {10, 1000, 10000, 50000}});
+
+ERASE_BENCHMARK(EraseLoop);
+ERASE_BENCHMARK(EraseIndices);
+ERASE_BENCHMARK(EraseMask);
+
+BENCHMARK_MAIN();
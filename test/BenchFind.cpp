@@ -0,0 +1,82 @@
+#include "Attractadore/TrivialVector.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <numeric>
+
+using Attractadore::InlineTrivialVector;
+using Attractadore::TrivialVector;
+
+// Looks up a value past the end of the vector, so every search is a full
+// scan, and every other one a miss
+template<typename Vec>
+Vec make_vector(size_t size) {
+    Vec vec(size);
+    std::iota(vec.begin(), vec.end(), 1);
+    return vec;
+}
+
+template<typename Vec>
+void RangesFind(benchmark::State& state)
+{
+    auto vec = make_vector<Vec>(state.range(0));
+    typename Vec::value_type value = vec.size();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(std::ranges::find(vec, value));
+        value ^= 1;
+    }
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+template<typename Vec>
+void MemberFind(benchmark::State& state)
+{
+    auto vec = make_vector<Vec>(state.range(0));
+    typename Vec::value_type value = vec.size();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(vec.find(value));
+        value ^= 1;
+    }
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+template<typename Vec>
+void RangesCount(benchmark::State& state)
+{
+    auto vec = make_vector<Vec>(state.range(0));
+    typename Vec::value_type value = vec.size();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(std::ranges::count(vec, value));
+    }
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+template<typename Vec>
+void MemberCount(benchmark::State& state)
+{
+    auto vec = make_vector<Vec>(state.range(0));
+    typename Vec::value_type value = vec.size();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(vec.count(value));
+    }
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+using SmallVec = InlineTrivialVector<uint32_t, 16>;
+using LargeVec = TrivialVector<uint64_t>;
+
+#define FIND_BENCHMARK(func) \
+    BENCHMARK_TEMPLATE(func, SmallVec)->DenseRange(1, 16, 3); \
+    BENCHMARK_TEMPLATE(func, LargeVec)->Range(8, 1 << 16);
+
+FIND_BENCHMARK(RangesFind);
+FIND_BENCHMARK(MemberFind);
+FIND_BENCHMARK(RangesCount);
+FIND_BENCHMARK(MemberCount);
+
+BENCHMARK_MAIN();
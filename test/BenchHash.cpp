@@ -0,0 +1,96 @@
+#include "Attractadore/TrivialVector.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+using Attractadore::FrozenVector;
+using Attractadore::InlineTrivialVector;
+using Attractadore::TrivialVector;
+
+inline constexpr size_t key_count = 1 << 14;
+
+// A byte at a time FNV-1a over the contents, as keys were hashed before
+struct BytewiseHash {
+    template<typename Vec>
+    size_t operator()(const Vec& vec) const noexcept {
+        size_t h = 0xcbf29ce484222325;
+        for (auto b: std::as_bytes(std::span{vec})) {
+            h = (h ^ size_t(b)) * 0x100000001b3;
+        }
+        return h;
+    }
+};
+
+template<typename Key, typename Vec = typename Key::Vector>
+std::vector<Key> make_keys(size_t key_size) {
+    std::mt19937 gen{42};
+    std::vector<Key> keys;
+    keys.reserve(key_count);
+    for (size_t i = 0; i < key_count; i++) {
+        Vec key;
+        key.resize(key_size);
+        for (auto& v: key) {
+            v = gen();
+        }
+        keys.emplace_back(std::move(key));
+    }
+    return keys;
+}
+
+// Hashes the vector on every use
+template<typename Vec>
+struct Plain {
+    using Vector = Vec;
+    Vec vec;
+    Plain(Vec vec): vec(std::move(vec)) {}
+    bool operator==(const Plain&) const = default;
+};
+
+template<typename Key, typename Hash, typename Vec = typename Key::Vector>
+void InsertLookup(benchmark::State& state)
+{
+    auto keys = make_keys<Key, Vec>(state.range(0));
+    for (auto _: state) {
+        std::unordered_map<Key, size_t, Hash> map;
+        map.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            map.emplace(keys[i], i);
+        }
+        size_t sum = 0;
+        for (const auto& key: keys) {
+            sum += map.find(key)->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size() * 2);
+}
+
+template<typename Hash>
+struct PlainHash {
+    template<typename Vec>
+    size_t operator()(const Plain<Vec>& key) const noexcept {
+        return Hash{}(key.vec);
+    }
+};
+
+using Dwords = InlineTrivialVector<uint32_t, 8>;
+using Bytes = TrivialVector<uint8_t>;
+
+BENCHMARK_TEMPLATE(InsertLookup, Plain<std::vector<uint32_t>>, PlainHash<BytewiseHash>)
+    ->Arg(4)->Arg(8)->Arg(64);
+BENCHMARK_TEMPLATE(InsertLookup, Plain<Dwords>, PlainHash<std::hash<Dwords>>)
+    ->Arg(4)->Arg(8)->Arg(64);
+BENCHMARK_TEMPLATE(InsertLookup, FrozenVector<Dwords>, std::hash<FrozenVector<Dwords>>, Dwords)
+    ->Arg(4)->Arg(8)->Arg(64);
+BENCHMARK_TEMPLATE(InsertLookup, Plain<std::vector<uint8_t>>, PlainHash<BytewiseHash>)
+    ->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(InsertLookup, Plain<Bytes>, PlainHash<std::hash<Bytes>>)
+    ->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(InsertLookup, FrozenVector<Bytes>, std::hash<FrozenVector<Bytes>>, Bytes)
+    ->Arg(16)->Arg(256);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,79 @@
+#include "Attractadore/TrivialVector.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using Attractadore::InlineTrivialVector;
+using Attractadore::TrivialVector;
+
+inline constexpr size_t vector_count = 1 << 12;
+
+// Every other vector is empty, the rest hold a few elements on the heap
+template<typename Vec>
+std::vector<Vec> make_vectors() {
+    std::vector<Vec> vecs(vector_count);
+    for (size_t i = 0; i < vector_count; i += 2) {
+        vecs[i].assign(8, int(i));
+    }
+    return vecs;
+}
+
+template<typename Vec>
+void MoveAssign(benchmark::State& state)
+{
+    auto src = make_vectors<Vec>();
+    std::vector<Vec> dst(vector_count);
+    for (auto _: state) {
+        for (size_t i = 0; i < vector_count; i++) {
+            dst[i] = std::move(src[i]);
+        }
+        for (size_t i = 0; i < vector_count; i++) {
+            src[i] = std::move(dst[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * vector_count * 2);
+}
+
+template<typename Vec>
+void Swap(benchmark::State& state)
+{
+    auto vecs = make_vectors<Vec>();
+    for (auto _: state) {
+        for (size_t i = 0; i + 1 < vector_count; i++) {
+            using std::swap;
+            swap(vecs[i], vecs[i + 1]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * (vector_count - 1));
+}
+
+// Moves every vector into a fresh array and destroys the moved-from ones
+template<typename Vec>
+void MoveConstructDestroy(benchmark::State& state)
+{
+    auto vecs = make_vectors<Vec>();
+    for (auto _: state) {
+        std::vector<Vec> moved(
+            std::make_move_iterator(vecs.begin()),
+            std::make_move_iterator(vecs.end()));
+        vecs.clear();
+        vecs.swap(moved);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * vector_count);
+}
+
+BENCHMARK(MoveAssign<std::vector<int>>);
+BENCHMARK(MoveAssign<TrivialVector<int>>);
+BENCHMARK(MoveAssign<InlineTrivialVector<int, 4>>);
+BENCHMARK(Swap<std::vector<int>>);
+BENCHMARK(Swap<TrivialVector<int>>);
+BENCHMARK(Swap<InlineTrivialVector<int, 4>>);
+BENCHMARK(MoveConstructDestroy<std::vector<int>>);
+BENCHMARK(MoveConstructDestroy<TrivialVector<int>>);
+BENCHMARK(MoveConstructDestroy<InlineTrivialVector<int, 4>>);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,45 @@
+#include "Attractadore/ParallelAlgorithms.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+
+using Attractadore::TrivialVector;
+
+// The thread count is the second argument, 1 being the serial member
+void Assign(benchmark::State& state)
+{
+    TrivialVector<double> vec(state.range(0) / sizeof(double));
+    unsigned threads = state.range(1);
+    for (auto _: state) {
+        Attractadore::parallel_assign(vec, vec.size(), 1.0, threads);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void Copy(benchmark::State& state)
+{
+    TrivialVector<double> vec(state.range(0) / sizeof(double));
+    std::iota(vec.begin(), vec.end(), 0.0);
+    unsigned threads = state.range(1);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(Attractadore::parallel_copy(vec, threads));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void ParallelArguments(benchmark::internal::Benchmark* b) {
+    auto max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (long size: {16l << 20, 256l << 20, 1l << 30}) {
+        for (long threads = 1; threads <= max_threads; threads *= 2) {
+            b->Args({size, threads});
+        }
+    }
+    b->UseRealTime();
+}
+
+BENCHMARK(Assign)->Apply(ParallelArguments);
+BENCHMARK(Copy)->Apply(ParallelArguments);
+
+BENCHMARK_MAIN();
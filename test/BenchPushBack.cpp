@@ -1,8 +1,18 @@
 #include "Attractadore/TrivialVector.hpp"
+#include "Attractadore/MMapAllocators.hpp"
 
 #include <benchmark/benchmark.h>
 
+#include <chrono>
+
 using Attractadore::TrivialVector;
+using Attractadore::DoubleGrowth;
+using Attractadore::HalfGrowth;
+using Attractadore::FixedGrowth;
+using Attractadore::PageGrowth;
+using Attractadore::MallocAllocator;
+using Attractadore::MMapAllocator;
+using Attractadore::populate;
 
 inline constexpr size_t final_size = 1 << 20;
 
@@ -55,9 +65,111 @@ void AllocAppend(benchmark::State& state) {
     }
 }
 
+// Tracks the peak number of bytes held by live allocations, which is what
+// a growth policy contributes to a process's peak RSS
+struct AllocationStats {
+    static inline size_t current = 0;
+    static inline size_t peak = 0;
+};
+
+template<typename T>
+struct CountingAllocator: std::allocator<T> {
+    template<typename U> struct rebind { using other = CountingAllocator<U>; };
+
+    T* allocate(size_t n) {
+        AllocationStats::current += n * sizeof(T);
+        AllocationStats::peak =
+            std::max(AllocationStats::peak, AllocationStats::current);
+        return std::allocator<T>::allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        AllocationStats::current -= n * sizeof(T);
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+template<typename GrowthPolicy>
+void TrivialVectorGrowthPushBack(benchmark::State& state) {
+    AllocationStats::peak = 0;
+    for (auto _: state) {
+        TrivialVector<int, CountingAllocator<int>, GrowthPolicy> v1;
+        benchmark::DoNotOptimize(v1.data());
+        for (size_t i = 0; i < final_size; i++) {
+            v1.push_back(i);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.counters["PeakBytes"] = AllocationStats::peak;
+    state.SetItemsProcessed(state.iterations() * final_size);
+}
+
+// Times every shove_back on its own, reports per-element latency percentiles
+template<bool Populate>
+void TrivialVectorReserveShoveBackLatency(benchmark::State& state) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<Clock::duration> latencies(final_size);
+    std::vector<Clock::duration> p99s, p999s, maxs;
+    for (auto _: state) {
+        state.PauseTiming();
+        TrivialVector<int> v1;
+        if constexpr (Populate) {
+            v1.reserve(final_size, populate);
+        } else {
+            v1.reserve(final_size);
+        }
+        benchmark::DoNotOptimize(v1.data());
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < final_size; i++) {
+            auto start = Clock::now();
+            v1.shove_back(i);
+            benchmark::ClobberMemory();
+            latencies[i] = Clock::now() - start;
+        }
+
+        state.PauseTiming();
+        std::ranges::sort(latencies);
+        p99s.push_back(latencies[latencies.size() * 99 / 100]);
+        p999s.push_back(latencies[latencies.size() * 999 / 1000]);
+        maxs.push_back(latencies.back());
+        state.ResumeTiming();
+    }
+    auto median_ns = [] (auto& samples) {
+        std::ranges::sort(samples);
+        return std::chrono::duration<double, std::nano>(
+            samples[samples.size() / 2]).count();
+    };
+    state.counters["p99_ns"] = median_ns(p99s);
+    state.counters["p999_ns"] = median_ns(p999s);
+    state.counters["max_ns"] = median_ns(maxs);
+}
+
+template<typename Allocator>
+void TrivialVectorPushBack(benchmark::State& state) {
+    for (auto _: state) {
+        TrivialVector<int, Allocator> v1;
+        benchmark::DoNotOptimize(v1.data());
+        for (size_t i = 0; i < final_size; i++) {
+            v1.push_back(i);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * final_size);
+}
+
 BENCHMARK(StdVectorReservePushBack);
 BENCHMARK(TrivialVectorReservePushBack);
 BENCHMARK(TrivialVectorReserveShoveBack);
 BENCHMARK(AllocAppend);
+BENCHMARK(TrivialVectorReserveShoveBackLatency<false>);
+BENCHMARK(TrivialVectorReserveShoveBackLatency<true>);
+BENCHMARK(TrivialVectorPushBack<std::allocator<int>>);
+BENCHMARK(TrivialVectorPushBack<MallocAllocator<int>>);
+BENCHMARK(TrivialVectorPushBack<MMapAllocator<int>>);
+BENCHMARK(TrivialVectorGrowthPushBack<DoubleGrowth>);
+BENCHMARK(TrivialVectorGrowthPushBack<HalfGrowth>);
+BENCHMARK(TrivialVectorGrowthPushBack<PageGrowth<>>);
+BENCHMARK(TrivialVectorGrowthPushBack<FixedGrowth<final_size / 16>>);
 
 BENCHMARK_MAIN();
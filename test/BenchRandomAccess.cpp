@@ -0,0 +1,43 @@
+#include "Attractadore/TrivialVector.hpp"
+#include "Attractadore/MMapAllocators.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+using Attractadore::TrivialVector;
+using Attractadore::HugePageAllocator;
+
+inline constexpr size_t accesses = 1 << 20;
+
+template<typename Allocator>
+void RandomAccess(benchmark::State& state)
+{
+    // Sizes are powers of two so that indexing is a mask
+    size_t size = state.range(0);
+    TrivialVector<uint64_t, Allocator> v1(size);
+    for (size_t i = 0; i < size; i++) {
+        v1[i] = i;
+    }
+    uint64_t x = 0x9E3779B97F4A7C15;
+    for (auto _: state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < accesses; i++) {
+            // xorshift64, cheap enough not to hide the TLB misses
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            sum += v1[x & (size - 1)];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * accesses);
+    state.SetBytesProcessed(state.iterations() * accesses * sizeof(uint64_t));
+}
+
+BENCHMARK(RandomAccess<std::allocator<uint64_t>>)
+    ->RangeMultiplier(4)->Range(1 << 16, 1 << 26);
+BENCHMARK(RandomAccess<HugePageAllocator<uint64_t>>)
+    ->RangeMultiplier(4)->Range(1 << 16, 1 << 26);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,148 @@
+#include "Attractadore/TrivialVector.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <thread>
+
+using Attractadore::Stream;
+using Attractadore::TrivialVector;
+
+struct Plain {};
+
+// Calls the plain or the streaming overload depending on the tag
+template<typename Tag, typename Vec, typename... Args>
+void assign(Vec& vec, Args&&... args) {
+    if constexpr (std::same_as<Tag, Stream>) {
+        vec.assign(std::forward<Args>(args)..., Attractadore::stream);
+    } else {
+        vec.assign(std::forward<Args>(args)...);
+    }
+}
+
+template<typename Tag>
+void Fill(benchmark::State& state)
+{
+    TrivialVector<uint64_t> vec(state.range(0) / sizeof(uint64_t));
+    for (auto _: state) {
+        assign<Tag>(vec, vec.size(), uint64_t(0x5555));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+template<typename Tag>
+void Copy(benchmark::State& state)
+{
+    TrivialVector<uint64_t> src(state.range(0) / sizeof(uint64_t));
+    std::iota(src.begin(), src.end(), 0);
+    TrivialVector<uint64_t> vec(src.size());
+    for (auto _: state) {
+        assign<Tag>(vec, src);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+template<typename Tag>
+void Append(benchmark::State& state)
+{
+    TrivialVector<uint64_t> src(state.range(0) / sizeof(uint64_t));
+    std::iota(src.begin(), src.end(), 0);
+    TrivialVector<uint64_t> vec;
+    vec.reserve(src.size());
+    for (auto _: state) {
+        vec.clear();
+        if constexpr (std::same_as<Tag, Stream>) {
+            vec.append(src, Attractadore::stream);
+        } else {
+            vec.append(src);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// A cache-sensitive workload: dependent random reads over a table that
+// fits in the L2 cache and is slowed down by anything that evicts it
+class Victim {
+    TrivialVector<uint32_t> m_next;
+    uint32_t m_pos = 0;
+
+public:
+    static constexpr size_t TableSize = size_t(256) << 10;
+
+    Victim(): m_next(TableSize / sizeof(uint32_t)) {
+        // A single random cycle through all entries defeats prefetching
+        std::iota(m_next.begin(), m_next.end(), 0);
+        std::shuffle(
+            m_next.data() + 1, m_next.data() + m_next.size(), std::mt19937{});
+        TrivialVector<uint32_t> cycle(m_next.size());
+        for (size_t i = 0; i < m_next.size(); i++) {
+            cycle[m_next[i]] = m_next[(i + 1) % m_next.size()];
+        }
+        m_next = std::move(cycle);
+    }
+
+    uint32_t run(size_t steps) {
+        for (size_t i = 0; i < steps; i++) {
+            m_pos = m_next[m_pos];
+        }
+        return m_pos;
+    }
+};
+
+constexpr size_t VictimSteps = 1 << 14;
+
+// Times the victim right after a large write, which with plain stores has
+// flushed its table out of the cache
+template<typename Tag>
+void VictimAfterWrite(benchmark::State& state)
+{
+    Victim victim;
+    TrivialVector<uint64_t> vec(state.range(0) / sizeof(uint64_t));
+    for (auto _: state) {
+        state.PauseTiming();
+        assign<Tag>(vec, vec.size(), uint64_t(0x5555));
+        benchmark::ClobberMemory();
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(victim.run(VictimSteps));
+    }
+    state.SetItemsProcessed(state.iterations() * VictimSteps);
+}
+
+// Times the victim while another thread keeps rewriting a large buffer.
+// Only meaningful on machines where the two threads actually share a cache.
+template<typename Tag>
+void VictimCoRunning(benchmark::State& state)
+{
+    Victim victim;
+    std::atomic<bool> stop = false;
+    std::jthread writer([&, size = state.range(0)] {
+        TrivialVector<uint64_t> vec(size / sizeof(uint64_t));
+        while (not stop.load(std::memory_order_relaxed)) {
+            assign<Tag>(vec, vec.size(), uint64_t(0x5555));
+            benchmark::ClobberMemory();
+        }
+    });
+    for (auto _: state) {
+        benchmark::DoNotOptimize(victim.run(VictimSteps));
+    }
+    stop = true;
+    state.SetItemsProcessed(state.iterations() * VictimSteps);
+}
+
+#define STREAM_BENCHMARK(func) \
+    BENCHMARK_TEMPLATE(func, Plain)->RangeMultiplier(4)->Range(1 << 20, 256 << 20); \
+    BENCHMARK_TEMPLATE(func, Stream)->RangeMultiplier(4)->Range(1 << 20, 256 << 20);
+
+STREAM_BENCHMARK(Fill);
+STREAM_BENCHMARK(Copy);
+STREAM_BENCHMARK(Append);
+STREAM_BENCHMARK(VictimAfterWrite);
+STREAM_BENCHMARK(VictimCoRunning);
+
+BENCHMARK_MAIN();
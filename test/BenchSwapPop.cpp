@@ -0,0 +1,64 @@
+#include "Attractadore/TrivialVector.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using Attractadore::TrivialVector;
+
+// Removes state.range(1) random elements out of state.range(0), as a pool
+// releasing a batch of its entries
+std::vector<size_t> make_indices(size_t size, size_t count) {
+    std::vector<size_t> indices(size);
+    std::iota(indices.begin(), indices.end(), 0);
+    std::ranges::shuffle(indices, std::mt19937{count});
+    indices.resize(count);
+    return indices;
+}
+
+// The correct way with single swap_pops: highest index first, so that no
+// element is moved before its own index comes up
+void SortedSwapPop(benchmark::State& state)
+{
+    TrivialVector<uint64_t> src(state.range(0));
+    auto indices = make_indices(state.range(0), state.range(1));
+    TrivialVector<uint64_t> vec;
+    std::vector<size_t> sorted;
+    for (auto _: state) {
+        state.PauseTiming();
+        vec = src;
+        sorted = indices;
+        state.ResumeTiming();
+        std::ranges::sort(sorted, std::greater{});
+        for (auto idx: sorted) {
+            vec.swap_pop(vec.begin() + idx);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * indices.size());
+}
+
+void SwapPopMany(benchmark::State& state)
+{
+    TrivialVector<uint64_t> src(state.range(0));
+    auto indices = make_indices(state.range(0), state.range(1));
+    TrivialVector<uint64_t> vec;
+    std::vector<size_t> scratch;
+    for (auto _: state) {
+        state.PauseTiming();
+        vec = src;
+        scratch = indices;
+        state.ResumeTiming();
+        vec.swap_pop_many(scratch);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * indices.size());
+}
+
+BENCHMARK(SortedSwapPop)->ArgsProduct({{100000}, {100, 1000, 10000}});
+BENCHMARK(SwapPopMany)->ArgsProduct({{100000}, {100, 1000, 10000}});
+
+BENCHMARK_MAIN();
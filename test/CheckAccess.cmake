@@ -0,0 +1,73 @@
+# Usage: cmake -DOBJDUMP=<objdump> -DOBJECT=<object file> -P CheckAccess.cmake
+#
+# Every codegen_* function in OBJECT must be straight-line code without
+# compares, conditional branches, conditional moves or calls, so that the
+# accessors it inlines don't test for inline storage. Every control_*
+# function must contain a compare or a conditional branch, which makes sure
+# the patterns below still recognize one.
+
+cmake_minimum_required(VERSION 3.15)
+
+execute_process(
+    COMMAND ${OBJDUMP} -dr --no-show-raw-insn ${OBJECT}
+    OUTPUT_VARIABLE disasm
+    RESULT_VARIABLE result)
+if (result)
+    message(FATAL_ERROR "${OBJDUMP} failed on ${OBJECT}")
+endif()
+
+# Brackets and semicolons confuse list handling
+string(REPLACE ";" "," disasm "${disasm}")
+string(REPLACE "[" "(" disasm "${disasm}")
+string(REPLACE "]" ")" disasm "${disasm}")
+string(REPLACE "\n" ";" lines "${disasm}")
+
+# x86-64 and AArch64 mnemonics that test a condition. Unconditional jumps
+# count too, they either belong to a branch or are tail calls.
+set(conditional "^(j[a-z]+|cmp[a-z]*|test[a-z]*|cmov[a-z]+|set[a-z]+|b\\.[a-z]+|cbn?z|tbn?z|csel|csinc|cset|tst|ccmp)$")
+set(call "^(call[a-z]*|bl?)$")
+
+set(functions)
+set(current)
+foreach (line IN LISTS lines)
+    if (line MATCHES "^[0-9a-f]+ <(.+)>:$")
+        set(current "${CMAKE_MATCH_1}")
+        string(MD5 key "${current}")
+        list(APPEND functions "${current}")
+        set(conditional_${key} FALSE)
+        set(call_${key} FALSE)
+    elseif (current AND line MATCHES "^ *[0-9a-f]+:\t([a-z.]+)")
+        set(mnemonic "${CMAKE_MATCH_1}")
+        if (mnemonic MATCHES "${conditional}")
+            set(conditional_${key} TRUE)
+        elseif (mnemonic MATCHES "${call}")
+            set(call_${key} TRUE)
+        endif()
+    endif()
+endforeach()
+
+set(checked 0)
+set(controls 0)
+set(failed)
+foreach (function IN LISTS functions)
+    string(MD5 key "${function}")
+    if (function MATCHES "^codegen_")
+        math(EXPR checked "${checked} + 1")
+        if (conditional_${key} OR call_${key})
+            list(APPEND failed "${function}")
+        endif()
+    elseif (function MATCHES "^control_")
+        math(EXPR controls "${controls} + 1")
+        if (NOT conditional_${key})
+            message(FATAL_ERROR "No compare or branch found in ${function}")
+        endif()
+    endif()
+endforeach()
+
+if (checked EQUAL 0 OR controls EQUAL 0)
+    message(FATAL_ERROR "No codegen_* or control_* functions found in ${OBJECT}")
+endif()
+if (failed)
+    message(FATAL_ERROR "Accessors test for inline storage: ${failed}")
+endif()
+message(STATUS "${checked} accessors load the data pointer directly")
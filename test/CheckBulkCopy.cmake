@@ -0,0 +1,80 @@
+# Usage: cmake -DOBJDUMP=<objdump> -DOBJECT=<object file> -P CheckBulkCopy.cmake
+#
+# Every codegen_* function in OBJECT, together with the library functions it
+# calls that were not inlined, must call memmove or memcpy.
+
+cmake_minimum_required(VERSION 3.15)
+
+execute_process(
+    COMMAND ${OBJDUMP} -dr --no-show-raw-insn ${OBJECT}
+    OUTPUT_VARIABLE disasm
+    RESULT_VARIABLE result)
+if (result)
+    message(FATAL_ERROR "${OBJDUMP} failed on ${OBJECT}")
+endif()
+
+# Brackets and semicolons confuse list handling
+string(REPLACE ";" "," disasm "${disasm}")
+string(REPLACE "[" "(" disasm "${disasm}")
+string(REPLACE "]" ")" disasm "${disasm}")
+string(REPLACE "\n" ";" lines "${disasm}")
+
+set(functions)
+set(current)
+foreach (line IN LISTS lines)
+    if (line MATCHES "^[0-9a-f]+ <(.+)>:$")
+        set(current "${CMAKE_MATCH_1}")
+        string(MD5 key "${current}")
+        list(APPEND functions "${current}")
+        set(calls_${key})
+    elseif (current AND line MATCHES "R_X86_64_(PLT32|PC32|CALL26|JUMP26)[ \t]+([^ \t+-]+)")
+        list(APPEND calls_${key} "${CMAKE_MATCH_2}")
+    elseif (current AND line MATCHES "R_AARCH64_(CALL26|JUMP26)[ \t]+([^ \t+-]+)")
+        list(APPEND calls_${key} "${CMAKE_MATCH_2}")
+    endif()
+endforeach()
+
+function(reaches_copy function out)
+    set(queue "${function}")
+    set(seen)
+    while (queue)
+        list(POP_FRONT queue name)
+        if (name IN_LIST seen)
+            continue()
+        endif()
+        list(APPEND seen "${name}")
+        string(MD5 key "${name}")
+        foreach (callee IN LISTS calls_${key})
+            if (callee MATCHES "^(memmove|memcpy)(@.*)?$")
+                set(${out} TRUE PARENT_SCOPE)
+                return()
+            endif()
+            if (callee MATCHES "TrivialVectorNameSpace" AND
+                NOT callee MATCHES "length_check" AND
+                callee IN_LIST functions)
+                list(APPEND queue "${callee}")
+            endif()
+        endforeach()
+    endwhile()
+    set(${out} FALSE PARENT_SCOPE)
+endfunction()
+
+set(checked 0)
+set(failed)
+foreach (function IN LISTS functions)
+    if (function MATCHES "^codegen_")
+        math(EXPR checked "${checked} + 1")
+        reaches_copy("${function}" ok)
+        if (NOT ok)
+            list(APPEND failed "${function}")
+        endif()
+    endif()
+endforeach()
+
+if (checked EQUAL 0)
+    message(FATAL_ERROR "No codegen_* functions found in ${OBJECT}")
+endif()
+if (failed)
+    message(FATAL_ERROR "Not lowered to memmove/memcpy: ${failed}")
+endif()
+message(STATUS "${checked} bulk paths lowered to memmove/memcpy")
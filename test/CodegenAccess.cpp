@@ -0,0 +1,66 @@
+#include "Attractadore/SmallTrivialVector.hpp"
+
+// Each function inlines one element accessor. CheckAccess.cmake
+// disassembles this object and requires the codegen_* functions to load the
+// data pointer without testing for inline storage, which only
+// control_inline_* still does.
+
+using Vec = Attractadore::TrivialVector<int>;
+using InlineVec = Attractadore::InlineTrivialVector<int, 4>;
+// Too large to be stored inline
+using SmallVec = Attractadore::SmallTrivialVector<std::array<int, 8>>;
+using InlineSmallVec = Attractadore::SmallTrivialVector<int>;
+
+extern "C" {
+int* codegen_data(Vec& vec) {
+    return vec.data();
+}
+
+const int* codegen_cdata(const Vec& vec) {
+    return vec.cdata();
+}
+
+int* codegen_begin(Vec& vec) {
+    return std::to_address(vec.begin());
+}
+
+int* codegen_end(Vec& vec) {
+    return std::to_address(vec.end());
+}
+
+int codegen_index(const Vec& vec, size_t idx) {
+    return vec[idx];
+}
+
+int codegen_front(const Vec& vec) {
+    return vec.front();
+}
+
+int codegen_back(const Vec& vec) {
+    return vec.back();
+}
+
+bool codegen_data_is_inlined(const Vec& vec) {
+    return vec.data_is_inlined();
+}
+
+const int* codegen_small_data(const SmallVec& vec) {
+    return vec.data()->data();
+}
+
+int codegen_small_index(const SmallVec& vec, size_t idx) {
+    return vec[idx][0];
+}
+
+bool codegen_small_data_is_inlined(const SmallVec& vec) {
+    return vec.data_is_inlined();
+}
+
+int* control_inline_data(InlineVec& vec) {
+    return vec.data();
+}
+
+int* control_inline_small_data(InlineSmallVec& vec) {
+    return vec.data();
+}
+}
@@ -0,0 +1,42 @@
+#include "Attractadore/SmallTrivialVector.hpp"
+
+// Each function exercises one bulk path. CheckBulkCopy.cmake disassembles
+// this object and requires every function to reach memmove or memcpy.
+
+using Vec = Attractadore::TrivialVector<int>;
+using InlineVec = Attractadore::InlineTrivialVector<int, 4>;
+using SmallVec = Attractadore::SmallTrivialVector<int>;
+
+extern "C" {
+void codegen_reserve(Vec& vec, size_t cap) {
+    vec.reserve(cap);
+}
+
+void codegen_insert(Vec& vec, size_t pos, const int* first, const int* last) {
+    vec.insert(vec.begin() + pos, first, last);
+}
+
+void codegen_erase(Vec& vec, size_t first, size_t last) {
+    vec.erase(vec.begin() + first, vec.begin() + last);
+}
+
+void codegen_assign(Vec& vec, const int* first, const int* last) {
+    vec.assign(first, last);
+}
+
+void codegen_copy_assign(Vec& dst, const Vec& src) {
+    dst = src;
+}
+
+void codegen_inline_shrink(InlineVec& vec) {
+    vec.shrink_to_fit();
+}
+
+void codegen_small_insert(SmallVec& vec, size_t pos, const int* first, const int* last) {
+    vec.insert(vec.begin() + pos, first, last);
+}
+
+void codegen_small_erase(SmallVec& vec, size_t first, size_t last) {
+    vec.erase(vec.begin() + first, vec.begin() + last);
+}
+}
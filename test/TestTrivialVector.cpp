@@ -1,9 +1,20 @@
 #include "Attractadore/TrivialVector.hpp"
+#include "Attractadore/MMapAllocators.hpp"
+#include "Attractadore/ParallelAlgorithms.hpp"
+#include "Attractadore/SmallTrivialVector.hpp"
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <cstring>
 #include <list>
+#include <numeric>
+#include <random>
 #include <ranges>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 
 using Attractadore::InlineTrivialVector;
 using Attractadore::TrivialVector;
@@ -159,6 +170,17 @@ TEST(TestCopyAssign, Inline) {
     EXPECT_TRUE(std::ranges::equal(vec, vec2));
 }
 
+TEST(TestCopyAssign, InlineFromHeap) {
+    InlineTrivialVector<int, 4> vec = {1, 2};
+    InlineTrivialVector<int, 4> vec2;
+    vec2.reserve(100);
+    vec2.append({7, 8});
+    vec = vec2;
+
+    EXPECT_TRUE(vec.data_is_inlined());
+    EXPECT_TRUE(std::ranges::equal(vec, vec2));
+}
+
 TEST(TestCopyAssign, Heap) {
     TrivialVector<int> vec;
     auto old_data = vec.data();
@@ -942,6 +964,243 @@ TEST(TestPlaceBack, EndWithRealloc) {
         << "Vec is " << vec;
 }
 
+TEST(TestAppendWith, Partial) {
+    TrivialVector<char> vec = {'a', 'b'};
+    auto written = vec.append_with(10, [] (char* dst, size_t max) {
+        EXPECT_EQ(max, 10);
+        std::memcpy(dst, "cde", 3);
+        return 3;
+    });
+    EXPECT_EQ(written, 3);
+    EXPECT_GE(vec.capacity(), 12);
+    EXPECT_TRUE(std::ranges::equal(vec, std::string_view{"abcde"}));
+
+    EXPECT_EQ(vec.append_with(0, [] (char*, size_t) { return 0; }), 0);
+    EXPECT_EQ(vec.size(), 5);
+}
+
+TEST(TestAppendWith, Grows) {
+    // Repeated appends grow the capacity geometrically
+    TrivialVector<int> vec;
+    size_t reallocations = 0;
+    auto cap = vec.capacity();
+    for (int i = 0; i < 1000; i++) {
+        vec.append_with(8, [&] (int* dst, size_t) {
+            dst[0] = i;
+            return 1;
+        });
+        if (vec.capacity() != cap) {
+            cap = vec.capacity();
+            reallocations++;
+        }
+    }
+    EXPECT_EQ(vec.size(), 1000);
+    EXPECT_LT(reallocations, 20);
+    EXPECT_EQ(vec[999], 999);
+}
+
+TEST(TestAppendWith, Throws) {
+    InlineTrivialVector<int, 2> vec = {1};
+    EXPECT_THROW(vec.append_with(4, [] (int*, size_t) -> size_t {
+        throw std::runtime_error{"decoder"};
+    }), std::runtime_error);
+    EXPECT_EQ(vec.size(), 1);
+    EXPECT_EQ(vec[0], 1);
+}
+
+TEST(TestAppendWith, Small) {
+    Attractadore::SmallTrivialVector<char> vec;
+    vec.append_with(4, [] (char* dst, size_t) { dst[0] = 'x'; return 1; });
+    EXPECT_TRUE(vec.data_is_inlined());
+    vec.append_with(100, [] (char* dst, size_t max) {
+        std::fill_n(dst, max, 'y');
+        return max;
+    });
+    EXPECT_FALSE(vec.data_is_inlined());
+    EXPECT_EQ(vec.size(), 101);
+    EXPECT_EQ(vec.front(), 'x');
+    EXPECT_EQ(vec.back(), 'y');
+}
+
+TEST(TestStream, Fill) {
+    using Attractadore::stream;
+    using Attractadore::StreamThreshold;
+    // Sizes on both sides of the threshold, starting at odd offsets so
+    // that the streamed body is preceded and followed by partial vectors
+    for (size_t count: {size_t(100), StreamThreshold / 2 + 3, StreamThreshold + 5}) {
+        for (size_t offset: {0, 1, 3}) {
+            TrivialVector<uint16_t> vec(offset, 1);
+            vec.append(count, 0xABCD, stream);
+            ASSERT_EQ(vec.size(), offset + count);
+            EXPECT_EQ(std::ranges::count(vec, 1), offset);
+            EXPECT_EQ(std::ranges::count(vec, 0xABCD), count);
+
+            vec.resize(vec.size() + count, 0x1234, stream);
+            EXPECT_EQ(std::ranges::count(vec, 0x1234), count);
+            EXPECT_EQ(vec.back(), 0x1234);
+        }
+    }
+
+    TrivialVector<char> bytes;
+    bytes.assign(StreamThreshold + 17, 'z', stream);
+    EXPECT_EQ(bytes.size(), StreamThreshold + 17);
+    EXPECT_EQ(std::ranges::count(bytes, 'z'), bytes.size());
+
+    // Elements that do not divide the vector width fall back to plain stores
+    struct Triple { char c[3]; };
+    TrivialVector<Triple> triples;
+    triples.assign(StreamThreshold, Triple{'a', 'b', 'c'}, stream);
+    EXPECT_TRUE(std::ranges::all_of(triples, [] (const Triple& t) {
+        return t.c[0] == 'a' and t.c[1] == 'b' and t.c[2] == 'c';
+    }));
+}
+
+TEST(TestStream, Copy) {
+    using Attractadore::stream;
+    std::vector<int> src(Attractadore::StreamThreshold / sizeof(int) + 11);
+    std::iota(src.begin(), src.end(), 0);
+    for (size_t offset: {0, 1, 5}) {
+        auto part = std::span(src).subspan(offset);
+        TrivialVector<int> vec;
+        vec.assign(part, stream);
+        EXPECT_TRUE(std::ranges::equal(vec, part));
+        vec.append(part, stream);
+        EXPECT_EQ(vec.size(), 2 * part.size());
+        EXPECT_TRUE(std::ranges::equal(vec | std::views::drop(part.size()), part));
+    }
+
+    // Appending the vector to itself
+    TrivialVector<int> self(src.begin(), src.end());
+    self.shrink_to_fit();
+    self.append(self, stream);
+    EXPECT_TRUE(std::ranges::equal(self | std::views::take(src.size()), src));
+    EXPECT_TRUE(std::ranges::equal(self | std::views::drop(src.size()), src));
+
+    // Non-contiguous ranges take the normal path
+    TrivialVector<int> vec;
+    vec.assign(std::views::iota(0, 1000), stream);
+    vec.append(std::views::iota(1000, 2000), stream);
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, 2000)));
+}
+
+TEST(TestParallel, Chunks) {
+    alignas(64) static char buffer[1000];
+    for (size_t offset: {0, 1, 7}) {
+        auto first = reinterpret_cast<uint32_t*>(buffer + offset * sizeof(uint32_t));
+        size_t count = 200;
+        size_t parts = 3;
+        size_t prev = 0;
+        for (size_t i = 1; i <= parts; i++) {
+            auto begin = Attractadore::TrivialVectorNameSpace::chunk_begin(
+                first, count, parts, i);
+            EXPECT_GE(begin, prev);
+            if (i < parts) {
+                EXPECT_EQ(reinterpret_cast<uintptr_t>(first + begin) % 64, 0);
+            }
+            prev = begin;
+        }
+        EXPECT_EQ(prev, count);
+    }
+
+    // Every element is visited exactly once
+    std::vector<int> visits(1001);
+    Attractadore::for_each_chunk(visits.data(), visits.size(), 4,
+        [] (int* chunk, size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                chunk[i]++;
+            }
+        });
+    EXPECT_EQ(std::ranges::count(visits, 1), visits.size());
+}
+
+TEST(TestParallel, FillAndCopy) {
+    auto count = 4 * Attractadore::ParallelChunkSize / sizeof(uint64_t) + 3;
+    EXPECT_EQ(Attractadore::parallel_thread_count(count * sizeof(uint64_t), 4), 4);
+    EXPECT_EQ(Attractadore::parallel_thread_count(100, 4), 1);
+
+    TrivialVector<uint64_t> vec = {1, 2};
+    Attractadore::parallel_resize(vec, count, 7, 4);
+    EXPECT_EQ(vec.size(), count);
+    EXPECT_EQ(vec[0], 1);
+    EXPECT_EQ(vec[1], 2);
+    EXPECT_EQ(std::ranges::count(vec, 7), count - 2);
+
+    Attractadore::parallel_assign(vec, count, 9, 4);
+    EXPECT_EQ(std::ranges::count(vec, 9), count);
+
+    std::iota(vec.begin(), vec.end(), 0);
+    auto copy = Attractadore::parallel_copy(vec, 4);
+    EXPECT_EQ(copy, vec);
+
+    TrivialVector<uint64_t> other;
+    Attractadore::parallel_assign(other, std::span(vec).subspan(1), 4);
+    EXPECT_TRUE(std::ranges::equal(other, std::span(vec).subspan(1)));
+
+    // A part of the vector itself is moved like assign does
+    auto expected = std::vector<uint64_t>(vec.begin() + 1, vec.end());
+    Attractadore::parallel_assign(vec, std::span(vec).subspan(1), 4);
+    EXPECT_TRUE(std::ranges::equal(vec, expected));
+
+    // Small and non-contiguous inputs take the serial path
+    Attractadore::parallel_assign(other, std::views::iota(0u, 10u), 4);
+    EXPECT_TRUE(std::ranges::equal(other, std::views::iota(0u, 10u)));
+    Attractadore::parallel_resize(other, 5, 0, 4);
+    EXPECT_EQ(other.size(), 5);
+}
+
+TEST(TestParallel, FirstTouch) {
+    auto count = 4 * Attractadore::ParallelChunkSize / sizeof(int);
+    TrivialVector<int> vec(1000);
+    std::iota(vec.begin(), vec.end(), 0);
+    Attractadore::parallel_reserve(vec, count, 4);
+    EXPECT_GE(vec.capacity(), count);
+    EXPECT_EQ(vec.size(), 1000);
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, 1000)));
+
+    // Does not shrink
+    auto capacity = vec.capacity();
+    Attractadore::parallel_reserve(vec, 10, 4);
+    EXPECT_EQ(vec.capacity(), capacity);
+
+    Attractadore::parallel_fit(vec, 2 * count, 4);
+    EXPECT_EQ(vec.size(), 2 * count);
+    Attractadore::parallel_fill(vec.data(), vec.size(), 3, 4);
+    EXPECT_EQ(std::ranges::count(vec, 3), vec.size());
+
+    // A large enough buffer keeps its contents
+    Attractadore::parallel_fit(vec, count, 4);
+    EXPECT_EQ(std::ranges::count(vec, 3), count);
+}
+
+TEST(TestNumaAllocator, Policy) {
+    using Attractadore::NumaAllocator;
+    using Attractadore::NumaPolicy;
+    EXPECT_EQ(NumaAllocator<int>::on_node(2).nodes(), 4);
+    EXPECT_EQ(NumaAllocator<int>::on_node(2).policy(), NumaPolicy::Bind);
+    EXPECT_NE(NumaAllocator<int>::on_node(0), NumaAllocator<int>());
+
+    // Node 0 always exists
+    TrivialVector<int, NumaAllocator<int>> vec(NumaAllocator<int>::on_node(0));
+    vec.resize(100000, 5);
+    vec.resize(1000000, 6);
+    EXPECT_EQ(std::ranges::count(vec, 5), 100000);
+    EXPECT_EQ(std::ranges::count(vec, 6), 900000);
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+    int mode = -1;
+    unsigned long nodes = 0;
+    if (syscall(SYS_get_mempolicy, &mode, &nodes, 8 * sizeof(nodes) + 1,
+            vec.data() + vec.size() - 1, MPOL_F_ADDR)) {
+        GTEST_SKIP() << "get_mempolicy is not available";
+    }
+    EXPECT_EQ(mode, MPOL_BIND);
+    EXPECT_EQ(nodes, 1);
+#endif
+
+    TrivialVector<int, NumaAllocator<int>> interleaved;
+    interleaved.assign(100000, 0);
+    EXPECT_EQ(std::ranges::count(interleaved, 0), 100000);
+}
+
 TEST(TestInsert, ValuesEmpty) {
     TrivialVector<int> vec;
     auto cnt = 5;
@@ -1156,6 +1415,29 @@ TEST(TestInsert, RAIterBackEmptyRange) {
         << "Vec is " << vec;
 }
 
+TEST(TestInsert, SelfAppendFull) {
+    // The source is the buffer that the reallocation replaces
+    TrivialVector<int> vec = {1, 2, 3, 4};
+    vec.shrink_to_fit();
+    ASSERT_EQ(vec.size(), vec.capacity());
+    vec.append(std::span(vec.data(), vec.size()));
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{1, 2, 3, 4, 1, 2, 3, 4}))
+        << "Vec is " << vec;
+
+    vec.shrink_to_fit();
+    ASSERT_EQ(vec.size(), vec.capacity());
+    vec.append(vec.begin(), vec.begin() + 2);
+    EXPECT_TRUE(std::ranges::equal(
+        vec, std::array{1, 2, 3, 4, 1, 2, 3, 4, 1, 2}))
+        << "Vec is " << vec;
+
+    InlineTrivialVector<int, 4> inl = {5, 6, 7, 8};
+    ASSERT_EQ(inl.size(), inl.capacity());
+    inl.insert(inl.end(), inl.begin(), inl.end());
+    EXPECT_TRUE(std::ranges::equal(inl, std::array{5, 6, 7, 8, 5, 6, 7, 8}))
+        << "Vec is " << inl;
+}
+
 TEST(TestInsert, UnsizedRangeEmpty) {
     std::list lst = {1, 2, 3, 4};
     TrivialVector<int> vec;
@@ -1871,6 +2153,38 @@ TEST(TestSwapPop, End) {
     );
 }
 
+TEST(TestSwapPop, Many) {
+    // Indices only before the new end, only past it, and mixed
+    std::mt19937 gen;
+    for (size_t k: {0, 1, 10, 50, 99, 100}) {
+        for (int trial = 0; trial < 10; trial++) {
+            TrivialVector<int> vec(100);
+            std::iota(vec.begin(), vec.end(), 0);
+            std::vector<size_t> indices(100);
+            std::iota(indices.begin(), indices.end(), 0);
+            std::ranges::shuffle(indices, gen);
+            if (trial == 1) {
+                std::ranges::sort(indices.begin(), indices.begin() + k);
+            } else if (trial == 2) {
+                std::ranges::sort(indices, std::greater{});
+            }
+            indices.resize(k);
+            std::set<int> expected(vec.begin(), vec.end());
+            for (auto idx: indices) {
+                expected.erase(idx);
+            }
+
+            vec.swap_pop_many(indices);
+            EXPECT_EQ(vec.size(), 100 - k);
+            EXPECT_TRUE(std::ranges::equal(std::set<int>(vec.begin(), vec.end()), expected));
+        }
+    }
+
+    std::vector<size_t> repeated = {1, 1};
+    TrivialVector<int> vec = {1, 2, 3};
+    EXPECT_ASSERT(vec.swap_pop_many(repeated));
+}
+
 TEST(TestResize, NoRealloc) {
     std::array arr = {1, 2, 3, 4};
     TrivialVector<int> vec(arr);
@@ -2031,6 +2345,145 @@ TEST(TestEraseIf, FreeFunc) {
         << "Vec is " << vec;
 }
 
+namespace {
+// Compares erase, erase_if and erase_if_batch against std::remove_if for
+// every size up to a few batches and pseudo-random contents
+template<typename T>
+void check_erase() {
+    uint32_t state = 12345;
+    auto next = [&] {
+        state = state * 1664525 + 1013904223;
+        return state >> 16;
+    };
+    for (size_t size = 0; size < 200; size += size < 70 ? 1 : 13) {
+        TrivialVector<T> vec(size);
+        for (auto& v: vec) {
+            v = T(next() % 4);
+        }
+        auto pred = [] (T v) { return v == T(1) or v == T(2); };
+
+        std::vector<T> expected(vec.begin(), vec.end());
+        std::erase(expected, T(3));
+        auto copy = vec;
+        ASSERT_EQ(erase(copy, T(3)), vec.size() - expected.size());
+        ASSERT_TRUE(std::ranges::equal(copy, expected)) << size;
+
+        std::erase_if(expected, pred);
+        auto copy2 = copy;
+        auto removed = copy.size() - expected.size();
+        ASSERT_EQ(erase_if(copy, pred), removed);
+        ASSERT_TRUE(std::ranges::equal(copy, expected)) << size;
+
+        auto batch_pred = [&] (std::span<const T> batch) {
+            EXPECT_LE(batch.size(), Attractadore::EraseBatchSize);
+            uint64_t mask = 0;
+            for (size_t i = 0; i < batch.size(); i++) {
+                mask |= uint64_t(pred(batch[i])) << i;
+            }
+            return mask;
+        };
+        ASSERT_EQ(erase_if_batch(copy2, batch_pred), removed);
+        ASSERT_TRUE(std::ranges::equal(copy2, expected)) << size;
+    }
+}
+
+struct Record {
+    uint32_t key, value;
+    bool operator==(const Record&) const = default;
+    explicit constexpr operator bool() const { return key; }
+};
+}
+
+TEST(TestErase, Types) {
+    check_erase<uint8_t>();
+    check_erase<int16_t>();
+    check_erase<int>();
+    check_erase<float>();
+    check_erase<uint64_t>();
+    check_erase<double>();
+}
+
+TEST(TestEraseIf, Batch) {
+    TrivialVector<Record> vec;
+    for (uint32_t i = 0; i < 1000; i++) {
+        vec.push_back({i, i * i});
+    }
+    auto cnt = erase_if_batch(vec, [] (std::span<const Record> batch) {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < batch.size(); i++) {
+            mask |= uint64_t(batch[i].key % 3 == 0) << i;
+        }
+        return mask;
+    });
+    EXPECT_EQ(cnt, 334);
+    EXPECT_EQ(vec.size(), 666);
+    EXPECT_TRUE(std::ranges::all_of(vec, [] (Record r) {
+        return r.key % 3 and r.value == r.key * r.key;
+    }));
+    EXPECT_TRUE(std::ranges::is_sorted(vec, {}, &Record::key));
+
+    // Nothing or everything
+    EXPECT_EQ(erase_if_batch(vec, [] (auto) { return 0; }), 0);
+    EXPECT_EQ(vec.size(), 666);
+    EXPECT_EQ(erase_if_batch(vec, [] (auto) { return ~uint64_t(0); }), 666);
+    EXPECT_TRUE(vec.empty());
+}
+
+TEST(TestErase, Indices) {
+    TrivialVector<uint32_t> vec(100);
+    std::iota(vec.begin(), vec.end(), 0);
+    std::vector<size_t> indices = {0, 1, 5, 5, 6, 50, 98, 99};
+    EXPECT_EQ(vec.erase_indices(indices), 7);
+    EXPECT_EQ(vec.size(), 93);
+    EXPECT_TRUE(std::ranges::none_of(vec, [] (uint32_t v) {
+        return v < 2 or v == 5 or v == 6 or v == 50 or v >= 98;
+    }));
+    EXPECT_TRUE(std::ranges::is_sorted(vec));
+
+    EXPECT_EQ(vec.erase_indices({}), 0);
+    EXPECT_EQ(vec.size(), 93);
+
+    std::vector<size_t> all(vec.size());
+    std::iota(all.begin(), all.end(), 0);
+    EXPECT_EQ(vec.erase_indices(all), 93);
+    EXPECT_TRUE(vec.empty());
+
+    std::vector<size_t> unsorted = {2, 1};
+    TrivialVector<int> small = {1, 2, 3};
+    EXPECT_ASSERT(small.erase_indices(unsorted));
+}
+
+TEST(TestErase, Mask) {
+    // From a few runs to most elements erased, so that both the run moves
+    // and the packed blocks are used
+    std::mt19937_64 gen;
+    for (int density: {0, 1, 8, 32, 63}) {
+        TrivialVector<uint32_t> vec(1000);
+        std::iota(vec.begin(), vec.end(), 0);
+        std::vector<uint64_t> mask(16);
+        for (size_t i = 0; i < vec.size(); i++) {
+            if (int(gen() % 64) < density) {
+                mask[i / 64] |= uint64_t(1) << (i % 64);
+            }
+        }
+        // Bits past the end are ignored
+        mask.back() |= ~uint64_t(0) << (1000 % 64);
+
+        auto erased = [&] (uint32_t v) { return mask[v / 64] >> (v % 64) & 1; };
+        auto expected_size = 1000 - std::ranges::count_if(std::views::iota(0u, 1000u), erased);
+        EXPECT_EQ(vec.erase_mask(mask), 1000 - expected_size);
+        EXPECT_EQ(vec.size(), expected_size);
+        EXPECT_TRUE(std::ranges::none_of(vec, erased));
+        EXPECT_TRUE(std::ranges::is_sorted(vec));
+    }
+
+    // A short mask leaves the elements past it alone
+    TrivialVector<char> vec(100, 'a');
+    std::array<uint64_t, 1> mask = {~uint64_t(0)};
+    EXPECT_EQ(vec.erase_mask(mask), 64);
+    EXPECT_EQ(vec.size(), 36);
+}
+
 TEST(TestCompare, EqualEmpty) {
     TrivialVector<int> vec1, vec2;
     EXPECT_EQ(vec1, vec2);
@@ -2079,6 +2532,67 @@ TEST(TestCompare, GreaterEqual) {
     EXPECT_GE(vec2, vec1);
 }
 
+namespace {
+// Checks == and <=> against the element wise algorithms for vectors that
+// first differ at every position of a few vectors' worth of elements
+template<typename T>
+void check_compare(T lo, T hi) {
+    for (size_t size = 0; size < 150; size += size < 70 ? 1 : 7) {
+        TrivialVector<T> base(size, lo);
+        for (size_t i = 0; i <= size; i++) {
+            auto other = base;
+            if (i < size) {
+                other[i] = hi;
+            } else {
+                other.push_back(lo);
+            }
+            ASSERT_NE(base, other);
+            ASSERT_EQ(base <=> other, std::strong_ordering::less) << size << " " << i;
+            ASSERT_EQ(other <=> base, std::strong_ordering::greater);
+            ASSERT_EQ(
+                base <=> other,
+                std::lexicographical_compare_three_way(
+                    base.begin(), base.end(), other.begin(), other.end()));
+        }
+        ASSERT_EQ(base, base);
+        ASSERT_EQ(base <=> base, std::strong_ordering::equal);
+    }
+}
+}
+
+TEST(TestCompare, Bytewise) {
+    check_compare<uint8_t>(1, 200);
+    check_compare<std::byte>(std::byte{1}, std::byte{200});
+    check_compare<signed char>(-100, 100);
+    check_compare<char>(1, 100);
+}
+
+TEST(TestCompare, WideIntegers) {
+    // The lower byte of hi is smaller, which memcmp would get wrong on
+    // little endian targets
+    check_compare<uint16_t>(0x00ff, 0x0100);
+    check_compare<uint32_t>(0x00ff, 0x0100);
+    check_compare<int64_t>(-1, 0x0100);
+    check_compare<uint64_t>(0xffff'ffff, 0x1'0000'0000);
+}
+
+TEST(TestCompare, FloatingPoint) {
+    TrivialVector<double> vec1 = {1.0, 0.0};
+    TrivialVector<double> vec2 = {1.0, -0.0};
+    EXPECT_EQ(vec1, vec2);
+    EXPECT_EQ(vec1 <=> vec2, std::partial_ordering::equivalent);
+    vec2.push_back(NAN);
+    EXPECT_NE(vec2, vec2);
+    check_compare<float>(-1.0f, 1.0f);
+}
+
+TEST(TestCompare, Small) {
+    Attractadore::SmallTrivialVector<uint32_t> vec1 = {1, 0x100};
+    Attractadore::SmallTrivialVector<uint32_t> vec2 = {1, 0xff, 3};
+    EXPECT_NE(vec1, vec2);
+    EXPECT_GT(vec1, vec2);
+}
+
 TEST(AsBytes, AsBytes) {
     TrivialVector<int> vec = {1, 2, 3, 4};
     auto bytes = vec.as_bytes();
@@ -2197,3 +2711,1008 @@ TEST(TestConstruct, FromNotEmptyPtr) {
     EXPECT_TRUE(
         std::ranges::equal(vec2, arr));
 }
+
+TEST(TestMallocAllocator, PushBack) {
+    TrivialVector<int, Attractadore::MallocAllocator<int>> vec;
+    std::vector<int> ref;
+    for (int i = 0; i < 1000; i++) {
+        vec.push_back(i);
+        ref.push_back(i);
+    }
+    EXPECT_GE(vec.capacity(), vec.size());
+    EXPECT_TRUE(std::ranges::equal(vec, ref));
+}
+
+TEST(TestMallocAllocator, InlineSpill) {
+    std::array arr = {1, 2, 3, 4, 5};
+    InlineTrivialVector<int, 2, Attractadore::MallocAllocator<int>> vec(arr);
+    EXPECT_FALSE(vec.data_is_inlined());
+    vec.reserve(100);
+    EXPECT_GE(vec.capacity(), 100);
+    EXPECT_TRUE(std::ranges::equal(vec, arr));
+    vec.shrink_to_fit();
+    EXPECT_TRUE(std::ranges::equal(vec, arr));
+}
+
+template<typename T>
+struct ExpandingAllocator {
+    using value_type = T;
+
+    // Every small allocation gets a full block that it can later expand into
+    static constexpr size_t BlockSize = 64;
+
+    size_t* expansions;
+
+    T* allocate(size_t n) {
+        return std::allocator<T>().allocate(std::max(n, BlockSize));
+    }
+
+    void deallocate(T* p, size_t n) {
+        std::allocator<T>().deallocate(p, std::max(n, BlockSize));
+    }
+
+    bool try_expand(T*, size_t, size_t new_n) {
+        if (new_n <= BlockSize) {
+            ++*expansions;
+            return true;
+        }
+        return false;
+    }
+
+    friend bool operator==(
+        const ExpandingAllocator&, const ExpandingAllocator&
+    ) = default;
+};
+
+TEST(TestTryExpand, Grow) {
+    using Alloc = ExpandingAllocator<int>;
+    size_t expansions = 0;
+    TrivialVector<int, Alloc> vec(Alloc{&expansions});
+    vec.push_back(0);
+    auto old_data = vec.data();
+    for (size_t i = 1; i < Alloc::BlockSize; i++) {
+        vec.push_back(i);
+    }
+    EXPECT_EQ(vec.data(), old_data);
+    EXPECT_EQ(vec.capacity(), Alloc::BlockSize);
+    EXPECT_GT(expansions, 0);
+
+    vec.push_back(Alloc::BlockSize);
+    EXPECT_GT(vec.capacity(), Alloc::BlockSize);
+    EXPECT_TRUE(std::ranges::equal(
+        vec, std::views::iota(0, int(Alloc::BlockSize) + 1)));
+}
+
+TEST(TestGrowthPolicy, Double) {
+    TrivialVector<int, std::allocator<int>, Attractadore::DoubleGrowth> vec;
+    vec.push_back(0);
+    EXPECT_EQ(vec.capacity(), 1);
+    vec.push_back(1);
+    EXPECT_EQ(vec.capacity(), 2);
+    vec.push_back(2);
+    EXPECT_EQ(vec.capacity(), 4);
+}
+
+TEST(TestGrowthPolicy, Half) {
+    TrivialVector<int, std::allocator<int>, Attractadore::HalfGrowth> vec;
+    std::vector<size_t> capacities;
+    for (int i = 0; i < 10; i++) {
+        vec.push_back(i);
+        if (capacities.empty() or capacities.back() != vec.capacity()) {
+            capacities.push_back(vec.capacity());
+        }
+    }
+    EXPECT_EQ(capacities, (std::vector<size_t>{1, 2, 3, 4, 6, 9, 13}));
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, 10)));
+}
+
+TEST(TestGrowthPolicy, Fixed) {
+    InlineTrivialVector<
+        int, 4, std::allocator<int>, Attractadore::FixedGrowth<16>> vec(4);
+    vec.push_back(0);
+    EXPECT_EQ(vec.capacity(), 20);
+    vec.resize(vec.capacity());
+    vec.push_back(0);
+    EXPECT_EQ(vec.capacity(), 36);
+}
+
+TEST(TestGrowthPolicy, Page) {
+    using Growth = Attractadore::PageGrowth<4096>;
+    TrivialVector<int, std::allocator<int>, Growth> vec(512);
+    vec.push_back(0);
+    EXPECT_EQ(vec.capacity(), 1024);
+    vec.resize(1500);
+    vec.shrink_to_fit();
+    vec.push_back(0);
+    EXPECT_EQ(vec.capacity(), 3072);
+}
+
+TEST(TestGrowthPolicy, FallbackToRequired) {
+    TrivialVector<int, std::allocator<int>, Attractadore::FixedGrowth<1>> vec;
+    vec.resize(100);
+    EXPECT_EQ(vec.capacity(), 100);
+}
+
+template<typename T>
+struct RoundingAllocator: std::allocator<T> {
+    template<typename U> struct rebind { using other = RoundingAllocator<U>; };
+
+    static constexpr size_t Granularity = 8;
+
+    Attractadore::AllocationResult<T*> allocate_at_least(size_t n) {
+        auto count = (n + Granularity - 1) / Granularity * Granularity;
+        return {std::allocator<T>::allocate(count), count};
+    }
+
+    void deallocate(T* p, size_t n) {
+        EXPECT_EQ(n % Granularity, 0);
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+TEST(TestAllocateAtLeast, Reserve) {
+    TrivialVector<int, RoundingAllocator<int>> vec;
+    vec.reserve(3);
+    EXPECT_EQ(vec.capacity(), 8);
+    vec.reserve(9);
+    EXPECT_EQ(vec.capacity(), 16);
+}
+
+TEST(TestAllocateAtLeast, Grow) {
+    TrivialVector<int, RoundingAllocator<int>> vec;
+    for (int i = 0; i < 20; i++) {
+        vec.push_back(i);
+        EXPECT_EQ(vec.capacity() % RoundingAllocator<int>::Granularity, 0);
+    }
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, 20)));
+}
+
+TEST(TestAllocateAtLeast, Fit) {
+    InlineTrivialVector<int, 2, RoundingAllocator<int>> vec;
+    vec.fit(5);
+    EXPECT_EQ(vec.size(), 5);
+    EXPECT_EQ(vec.capacity(), 8);
+    vec.shrink_to_fit();
+    EXPECT_EQ(vec.capacity(), 8);
+}
+
+TEST(TestMallocAllocator, UsableCapacity) {
+    TrivialVector<char, Attractadore::MallocAllocator<char>> vec;
+    vec.reserve(1);
+    EXPECT_GE(vec.capacity(), 1);
+    auto capacity = vec.capacity();
+    vec.resize(capacity, 'a');
+    EXPECT_EQ(vec.capacity(), capacity);
+    vec.push_back('b');
+    EXPECT_GT(vec.capacity(), capacity);
+    EXPECT_EQ(std::ranges::count(vec, 'a'), capacity);
+}
+
+TEST(TestHugePageAllocator, Small) {
+    // Small vectors come from malloc rather than a page of their own
+    using Alloc = Attractadore::HugePageAllocator<int>;
+    TrivialVector<int, Alloc> vec = {1, 2, 3};
+    EXPECT_LT(vec.capacity() * sizeof(int), 4096);
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{1, 2, 3}));
+    vec.assign(100000, 7);
+    EXPECT_LT(vec.capacity() * sizeof(int), size_t(2) << 20);
+    EXPECT_EQ(std::ranges::count(vec, 7), 100000);
+
+    TrivialVector<int, Alloc> zeros;
+    zeros.resize(1000, 0);
+    EXPECT_EQ(std::ranges::count(zeros, 0), 1000);
+}
+
+TEST(TestHugePageAllocator, Large) {
+    using Alloc = Attractadore::HugePageAllocator<int>;
+    constexpr size_t huge_page_size = 2 << 20;
+    TrivialVector<int, Alloc> vec;
+    int cnt = huge_page_size / sizeof(int) + 1;
+    for (int i = 0; i < cnt; i++) {
+        vec.push_back(i);
+    }
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(vec.data()) % huge_page_size, 0);
+    EXPECT_EQ(vec.capacity() * sizeof(int) % huge_page_size, 0);
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, cnt)));
+    vec.shrink_to_fit();
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, cnt)));
+}
+
+TEST(TestMMapAllocator, GrowAcrossThreshold) {
+    using Alloc = Attractadore::MMapAllocator<int, 4096>;
+    TrivialVector<int, Alloc> vec;
+    int cnt = 100000;
+    for (int i = 0; i < cnt; i++) {
+        vec.push_back(i);
+    }
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(vec.data()) % 4096, 0);
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, cnt)));
+}
+
+TEST(TestMMapAllocator, ShrinkAcrossThreshold) {
+    using Alloc = Attractadore::MMapAllocator<int, 4096>;
+    TrivialVector<int, Alloc> vec(std::views::iota(0, 10000));
+    vec.truncate(10);
+    vec.shrink_to_fit();
+    EXPECT_LT(vec.capacity() * sizeof(int), 4096);
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, 10)));
+    vec.reserve(5000);
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, 10)));
+}
+
+TEST(TestVirtualReserveAllocator, NeverMoves) {
+    using Alloc = Attractadore::VirtualReserveAllocator<int>;
+    Attractadore::StableTrivialVector<int> vec(Alloc(1 << 20));
+    vec.push_back(0);
+    auto old_data = vec.data();
+    for (int i = 1; i < 1000; i++) {
+        vec.emplace_back(i);
+    }
+    auto placed = vec.place_back(1000);
+    std::iota(placed, vec.end(), 1000);
+    vec.append(std::views::iota(2000, 100000));
+    vec.append(100000, 0);
+    EXPECT_EQ(vec.data(), old_data);
+    EXPECT_TRUE(std::ranges::equal(
+        vec | std::views::take(100000), std::views::iota(0, 100000)));
+}
+
+TEST(TestVirtualReserveAllocator, MiddleInsertNeverMoves) {
+    using Alloc = Attractadore::VirtualReserveAllocator<int>;
+    Attractadore::StableTrivialVector<int> vec(Alloc(1 << 20));
+    vec.assign({1, 2, 3, 4});
+    auto old_data = vec.data();
+    auto old_capacity = vec.capacity();
+    std::vector<int> middle(old_capacity, 0);
+    vec.insert(vec.begin() + 2, middle.begin(), middle.end());
+    vec.insert(vec.begin() + 1, 2 * old_capacity, 5);
+    vec.emplace(vec.begin(), 0);
+    EXPECT_GT(vec.capacity(), old_capacity);
+    EXPECT_EQ(vec.data(), old_data);
+    EXPECT_EQ(vec.size(), 5 + 3 * old_capacity);
+    EXPECT_EQ(vec[0], 0);
+    EXPECT_EQ(vec[1], 1);
+    EXPECT_EQ(vec[2], 5);
+    EXPECT_EQ(vec.back(), 4);
+}
+
+TEST(TestVirtualReserveAllocator, CommitsPages) {
+    using Alloc = Attractadore::VirtualReserveAllocator<int>;
+    Attractadore::StableTrivialVector<int> vec(Alloc(1 << 20));
+    vec.push_back(0);
+    EXPECT_EQ(vec.capacity() * sizeof(int) % 4096, 0);
+    vec.assign(5000, 1);
+    EXPECT_EQ(vec.capacity() * sizeof(int) % 4096, 0);
+}
+
+TEST(TestVirtualReserveAllocator, ReservationExhausted) {
+    using Alloc = Attractadore::VirtualReserveAllocator<int>;
+    Attractadore::StableTrivialVector<int> vec(Alloc(1 << 16));
+    vec.resize((1 << 16) / sizeof(int), 1);
+    auto old_data = vec.data();
+    EXPECT_THROW(vec.push_back(0), std::bad_alloc);
+    EXPECT_EQ(vec.data(), old_data);
+    EXPECT_EQ(std::ranges::count(vec, 1), vec.size());
+}
+
+template<typename T>
+struct ZeroingAllocator: std::allocator<T> {
+    template<typename U> struct rebind { using other = ZeroingAllocator<U>; };
+
+    size_t* zeroed;
+
+    ZeroingAllocator(size_t* zeroed): zeroed(zeroed) {}
+
+    T* allocate_zeroed(size_t n) {
+        ++*zeroed;
+        auto p = std::allocator<T>::allocate(n);
+        std::memset(p, 0, n * sizeof(T));
+        return p;
+    }
+};
+
+TEST(TestZeroedAllocation, Construct) {
+    size_t zeroed = 0;
+    TrivialVector<int, ZeroingAllocator<int>> vec(
+        1000, 0, ZeroingAllocator<int>(&zeroed));
+    EXPECT_EQ(zeroed, 1);
+    EXPECT_EQ(vec.size(), 1000);
+    EXPECT_EQ(std::ranges::count(vec, 0), vec.size());
+}
+
+TEST(TestZeroedAllocation, ConstructNonZero) {
+    size_t zeroed = 0;
+    TrivialVector<float, ZeroingAllocator<float>> vec(
+        1000, -0.0f, ZeroingAllocator<float>(&zeroed));
+    EXPECT_EQ(zeroed, 0);
+    EXPECT_TRUE(std::ranges::all_of(vec, [] (float f) {
+        return std::signbit(f);
+    }));
+}
+
+TEST(TestZeroedAllocation, Assign) {
+    size_t zeroed = 0;
+    InlineTrivialVector<int, 4, ZeroingAllocator<int>> vec(
+        std::array{1, 2, 3}, ZeroingAllocator<int>(&zeroed));
+    vec.assign(4, 0);
+    EXPECT_EQ(zeroed, 0);
+    vec.assign(100, 0);
+    EXPECT_EQ(zeroed, 1);
+    EXPECT_EQ(std::ranges::count(vec, 0), 100);
+}
+
+TEST(TestZeroedAllocation, Resize) {
+    size_t zeroed = 0;
+    TrivialVector<int, ZeroingAllocator<int>> vec(
+        std::array{1, 2, 3}, ZeroingAllocator<int>(&zeroed));
+    vec.resize(100, 0);
+    EXPECT_EQ(zeroed, 1);
+    EXPECT_EQ(vec.size(), 100);
+    EXPECT_TRUE(std::ranges::equal(
+        vec | std::views::take(3), std::array{1, 2, 3}));
+    EXPECT_EQ(std::ranges::count(vec | std::views::drop(3), 0), 97);
+}
+
+TEST(TestZeroedAllocation, Malloc) {
+    TrivialVector<int, Attractadore::MallocAllocator<int>> vec(1 << 20, 0);
+    EXPECT_EQ(std::ranges::count(vec, 0), vec.size());
+    vec.resize(vec.size() * 2, 0);
+    EXPECT_EQ(std::ranges::count(vec, 0), vec.size());
+}
+
+TEST(TestZeroedAllocation, MMap) {
+    TrivialVector<int, Attractadore::MMapAllocator<int>> vec(1 << 20, 0);
+    EXPECT_EQ(std::ranges::count(vec, 0), vec.size());
+    vec.assign(10, 0);
+    EXPECT_EQ(std::ranges::count(vec, 0), vec.size());
+}
+
+TEST(TestReservePopulate, Heap) {
+    TrivialVector<int> vec = {1, 2, 3};
+    vec.reserve(1 << 20, Attractadore::populate);
+    EXPECT_GE(vec.capacity(), 1 << 20);
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{1, 2, 3}));
+}
+
+TEST(TestReservePopulate, Inline) {
+    InlineTrivialVector<int, 4> vec = {1, 2, 3};
+    vec.reserve(4, Attractadore::populate);
+    EXPECT_TRUE(vec.data_is_inlined());
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{1, 2, 3}));
+}
+
+TEST(TestReservePopulate, MMap) {
+    TrivialVector<int, Attractadore::MMapAllocator<int>> vec(
+        std::views::iota(0, 1000));
+    vec.reserve_more(1 << 20, Attractadore::populate);
+    EXPECT_GE(vec.capacity(), 1000 + (1 << 20));
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, 1000)));
+}
+
+TEST(TestAlignment, Inline) {
+    Attractadore::AlignedInlineTrivialVector<float, 64> vec = {1.0f, 2.0f};
+    static_assert(decltype(vec)::alignment == 64);
+    EXPECT_TRUE(vec.data_is_inlined());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(vec.data()) % 64, 0);
+}
+
+TEST(TestAlignment, Heap) {
+    Attractadore::AlignedInlineTrivialVector<float, 64, 4> vec;
+    for (int i = 0; i < 100; i++) {
+        vec.push_back(i);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(vec.data()) % 64, 0);
+    }
+    EXPECT_FALSE(vec.data_is_inlined());
+    vec.truncate(2);
+    vec.shrink_to_fit();
+    EXPECT_TRUE(vec.data_is_inlined());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(vec.data()) % 64, 0);
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{0.0f, 1.0f}));
+}
+
+TEST(TestAlignment, Swap) {
+    Attractadore::AlignedInlineTrivialVector<double, 32, 4> vec1 = {1, 2};
+    Attractadore::AlignedInlineTrivialVector<double, 32, 4> vec2 = {1, 2, 3, 4, 5};
+    vec1.swap(vec2);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(vec1.data()) % 32, 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(vec2.data()) % 32, 0);
+    EXPECT_EQ(vec1.size(), 5);
+    EXPECT_EQ(vec2.size(), 2);
+}
+
+TEST(TestAlignment, Default) {
+    static_assert(TrivialVector<char>::alignment == 1);
+    static_assert(
+        sizeof(InlineTrivialVector<char, 8>) ==
+        sizeof(TrivialVector<char>) + 8);
+}
+
+TEST(TestCompact, Layout) {
+    using Vec = Attractadore::CompactTrivialVector<int>;
+    static_assert(std::same_as<Vec::size_type, uint32_t>);
+    static_assert(Vec::max_size() == std::numeric_limits<uint32_t>::max() / sizeof(int));
+    static_assert(sizeof(Vec) == sizeof(int*) + 2 * sizeof(uint32_t));
+    static_assert(sizeof(Vec) < sizeof(TrivialVector<int>));
+}
+
+TEST(TestCompact, PushBack) {
+    Attractadore::CompactInlineTrivialVector<int, 4> vec;
+    for (int i = 0; i < 1000; i++) {
+        vec.push_back(i);
+    }
+    EXPECT_FALSE(vec.data_is_inlined());
+    EXPECT_TRUE(std::ranges::equal(vec, std::views::iota(0, 1000)));
+    vec.truncate(3);
+    vec.shrink_to_fit();
+    EXPECT_TRUE(vec.data_is_inlined());
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{0, 1, 2}));
+}
+
+TEST(TestCompact, Malloc) {
+    Attractadore::CompactTrivialVector<int, Attractadore::MallocAllocator<int>> vec(3, 0);
+    vec.append(1000, 7);
+    EXPECT_EQ(vec.size(), 1003);
+    EXPECT_GE(vec.capacity(), vec.size());
+    EXPECT_EQ(std::ranges::count(vec, 7), 1000);
+}
+
+TEST(TestCompact, LengthError) {
+    Attractadore::CompactTrivialVector<int> vec(10);
+    auto max_size = vec.max_size();
+    EXPECT_THROW(vec.reserve(max_size + 1), std::length_error);
+    EXPECT_THROW(vec.resize(max_size + 1), std::length_error);
+    EXPECT_THROW(vec.reserve_more(max_size), std::length_error);
+    EXPECT_THROW(vec.place_back(max_size), std::length_error);
+    auto huge = std::views::iota(size_t(0), size_t(1) << 33);
+    EXPECT_THROW(vec.append(huge), std::length_error);
+    EXPECT_THROW(vec.assign(huge), std::length_error);
+    EXPECT_EQ(vec.size(), 10);
+}
+
+TEST(TestRelocate, Trait) {
+    using Attractadore::is_trivially_relocatable_v;
+    static_assert(is_trivially_relocatable_v<InlineTrivialVector<int>>);
+    static_assert(is_trivially_relocatable_v<TrivialVector<int>>);
+    static_assert(is_trivially_relocatable_v<
+        Attractadore::CompactInlineTrivialVector<char, 8>>);
+    static_assert(not is_trivially_relocatable_v<std::list<int>>);
+}
+
+template<typename Vec>
+static void relocate_and_check(Vec src_value) {
+    auto ref = std::vector(src_value.begin(), src_value.end());
+    alignas(Vec) std::byte src_buf[sizeof(Vec)];
+    alignas(Vec) std::byte dst_buf[sizeof(Vec)];
+    std::construct_at(reinterpret_cast<Vec*>(src_buf), std::move(src_value));
+    std::memcpy(dst_buf, src_buf, sizeof(Vec));
+    std::memset(src_buf, 0xff, sizeof(Vec));
+    auto& dst = *std::launder(reinterpret_cast<Vec*>(dst_buf));
+    EXPECT_TRUE(std::ranges::equal(dst, ref));
+    dst.append(100, 7);
+    EXPECT_TRUE(std::ranges::equal(dst | std::views::take(ref.size()), ref));
+    std::destroy_at(&dst);
+}
+
+TEST(TestRelocate, Inline) {
+    relocate_and_check(InlineTrivialVector<int, 4>{1, 2, 3});
+}
+
+TEST(TestRelocate, Heap) {
+    relocate_and_check(InlineTrivialVector<int, 4>{1, 2, 3, 4, 5, 6});
+    relocate_and_check(TrivialVector<int>{1, 2, 3});
+}
+
+TEST(TestRelocate, NestedVectors) {
+    TrivialVector<InlineTrivialVector<int, 4>> vec;
+    std::vector<const int*> heap_data;
+    for (int i = 0; i < 100; i++) {
+        auto& inner = vec.emplace_back();
+        for (int j = 0; j < i % 8; j++) {
+            inner.push_back(i + j);
+        }
+        heap_data.push_back(inner.data_is_inlined() ? nullptr : inner.data());
+    }
+    vec.emplace(vec.begin(), InlineTrivialVector<int, 4>(3, -1));
+    vec.erase(vec.begin() + 50);
+    heap_data.erase(heap_data.begin() + 49);
+    for (int i = 0; i < 99; i++) {
+        auto& inner = vec[i + 1];
+        int k = i < 49 ? i : i + 1;
+        ASSERT_EQ(inner.size(), size_t(k % 8));
+        EXPECT_TRUE(std::ranges::equal(inner, std::views::iota(k, k + k % 8)));
+        // Relocated heap vectors keep their buffers, inline ones their
+        // elements
+        EXPECT_EQ(inner.data_is_inlined(), heap_data[i] == nullptr);
+        if (heap_data[i]) {
+            EXPECT_EQ(inner.data(), heap_data[i]);
+        }
+    }
+    EXPECT_EQ(vec.front(), (InlineTrivialVector<int, 4>(3, -1)));
+
+    TrivialVector<TrivialVector<int>> heap_vec(10);
+    heap_vec[9].push_back(9);
+    heap_vec.resize(1000);
+    EXPECT_EQ(heap_vec[9], TrivialVector<int>{9});
+}
+
+// Owns its value on the heap and counts its constructions, so that leaked,
+// doubly destroyed and move constructed elements show up
+struct Owned {
+    static inline int live = 0;
+    static inline int moves = 0;
+
+    std::unique_ptr<int> value;
+
+    Owned(int v = 0): value(std::make_unique<int>(v)) {
+        live++;
+    }
+
+    Owned(Owned&& other) noexcept: value(std::move(other.value)) {
+        live++;
+        moves++;
+    }
+
+    Owned& operator=(Owned&&) noexcept = default;
+
+    ~Owned() {
+        live--;
+    }
+
+    friend bool operator==(const Owned& lhs, int rhs) {
+        return lhs.value and *lhs.value == rhs;
+    }
+};
+
+template<>
+struct Attractadore::TrivialVectorNameSpace::is_trivially_relocatable<Owned>:
+    std::true_type {};
+
+static_assert(not std::copy_constructible<TrivialVector<Owned>>);
+static_assert(std::movable<InlineTrivialVector<Owned, 4>>);
+
+TEST(TestRelocate, NonTrivialElements) {
+    {
+        TrivialVector<Owned> vec;
+        for (int i = 0; i < 100; i++) {
+            vec.emplace_back(i);
+        }
+        // Growing and shifting relocates, only the new element is moved
+        // into place
+        Owned::moves = 0;
+        vec.reserve(1000);
+        vec.emplace(vec.begin(), -1);
+        EXPECT_EQ(Owned::moves, 1);
+        vec.insert(vec.begin() + 50, Owned(-2));
+        EXPECT_EQ(Owned::live, 102);
+
+        vec.erase(vec.begin());
+        vec.erase(vec.begin() + 49);
+        vec.erase(vec.begin() + 10, vec.begin() + 20);
+        EXPECT_EQ(vec.pop_back(), 99);
+        vec.swap_pop(vec.begin());
+        std::array<size_t, 3> indices = {3, 5, 7};
+        vec.erase_indices(indices);
+        erase_if(vec, [] (const Owned& o) { return *o.value % 2; });
+        vec.resize(vec.size() + 5);
+        vec.resize(20);
+        std::array<uint64_t, 1> mask = {0b1011};
+        vec.erase_mask(mask);
+        std::array<size_t, 2> pop_indices = {0, 16};
+        vec.swap_pop_many(pop_indices);
+        EXPECT_EQ(Owned::live, int(vec.size()));
+        EXPECT_TRUE(std::ranges::all_of(vec, [] (const Owned& o) {
+            return o.value != nullptr;
+        }));
+        vec.truncate(5);
+        EXPECT_EQ(Owned::live, 5);
+    }
+    EXPECT_EQ(Owned::live, 0);
+}
+
+TEST(TestRelocate, NonTrivialInlineElements) {
+    {
+        InlineTrivialVector<Owned, 4> inl;
+        InlineTrivialVector<Owned, 4> heap;
+        for (int i = 0; i < 3; i++) {
+            inl.emplace_back(i);
+        }
+        for (int i = 0; i < 10; i++) {
+            heap.emplace_back(10 + i);
+        }
+        inl.swap(heap);
+        EXPECT_EQ(heap.size(), 3);
+        EXPECT_EQ(inl.size(), 10);
+        EXPECT_EQ(heap[2], 2);
+        EXPECT_EQ(inl[9], 19);
+
+        InlineTrivialVector<Owned, 4> other;
+        other.emplace_back(-1);
+        other.swap(heap);
+        EXPECT_EQ(other.size(), 3);
+        EXPECT_EQ(heap.size(), 1);
+        EXPECT_EQ(other[1], 1);
+        EXPECT_EQ(heap[0], -1);
+
+        heap = std::move(other);
+        EXPECT_EQ(heap.size(), 3);
+        EXPECT_TRUE(other.empty());
+        inl = std::move(heap);
+        EXPECT_EQ(inl.size(), 3);
+        inl.shrink_to_fit();
+        auto moved = std::move(inl);
+        EXPECT_EQ(moved[0], 0);
+        EXPECT_EQ(Owned::live, 3);
+    }
+    EXPECT_EQ(Owned::live, 0);
+}
+
+TEST(TestShrink, ToInlineKeepsData) {
+    InlineTrivialVector<int, 4> vec = {1, 2, 3, 4};
+    vec.append({5, 6, 7, 8});
+    EXPECT_FALSE(vec.data_is_inlined());
+    std::ranges::fill(vec, 9);
+    vec.truncate(3);
+    vec.shrink_to_fit();
+    EXPECT_TRUE(vec.data_is_inlined());
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{9, 9, 9}));
+}
+
+TEST(TestSmallTrivialVector, Layout) {
+    using Attractadore::SmallTrivialVector;
+    using Attractadore::CompactSmallTrivialVector;
+    static_assert(sizeof(SmallTrivialVector<char>) == 3 * sizeof(void*));
+    static_assert(SmallTrivialVector<char>::max_inline_size() == 3 * sizeof(void*) - 1);
+    static_assert(SmallTrivialVector<uint16_t>::max_inline_size() == (3 * sizeof(void*) - 1) / 2);
+    static_assert(sizeof(CompactSmallTrivialVector<char>) == sizeof(void*) + 8);
+    static_assert(CompactSmallTrivialVector<char>::max_inline_size() == sizeof(void*) + 7);
+    static_assert(Attractadore::is_trivially_relocatable_v<SmallTrivialVector<char>>);
+}
+
+TEST(TestSmallTrivialVector, PushBack) {
+    Attractadore::SmallTrivialVector<char> vec;
+    std::vector<char> ref;
+    EXPECT_TRUE(vec.empty());
+    EXPECT_TRUE(vec.data_is_inlined());
+    for (int i = 0; i < 1000; i++) {
+        vec.push_back(char(i));
+        ref.push_back(char(i));
+        EXPECT_EQ(vec.data_is_inlined(), ref.size() <= vec.max_inline_size());
+        EXPECT_EQ(vec.size(), ref.size());
+        EXPECT_GE(vec.capacity(), vec.size());
+    }
+    EXPECT_TRUE(std::ranges::equal(vec, ref));
+    vec.truncate(5);
+    vec.shrink_to_fit();
+    EXPECT_TRUE(vec.data_is_inlined());
+    EXPECT_TRUE(std::ranges::equal(vec, ref | std::views::take(5)));
+}
+
+TEST(TestSmallTrivialVector, InsertErase) {
+    Attractadore::SmallTrivialVector<int> vec = {1, 2, 3};
+    vec.insert(vec.begin() + 1, {7, 8});
+    EXPECT_TRUE(vec.data_is_inlined());
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{1, 7, 8, 2, 3}));
+    vec.insert(vec.begin(), 3, vec[4]);
+    EXPECT_FALSE(vec.data_is_inlined());
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{3, 3, 3, 1, 7, 8, 2, 3}));
+    vec.insert(vec.begin() + 2, vec.begin(), vec.end());
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{
+        3, 3, 3, 3, 3, 1, 7, 8, 2, 3, 3, 1, 7, 8, 2, 3}));
+    vec.erase(vec.begin(), vec.begin() + 11);
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{1, 7, 8, 2, 3}));
+    vec.erase(vec.begin() + 1);
+    EXPECT_TRUE(std::ranges::equal(vec, std::array{1, 8, 2, 3}));
+    EXPECT_EQ(vec.pop_back(), 3);
+    EXPECT_EQ(vec.back(), 2);
+}
+
+// Counts the elements currently allocated by all instances
+template<typename T>
+struct LiveAllocator: std::allocator<T> {
+    template<typename U> struct rebind { using other = LiveAllocator<U>; };
+
+    static inline ptrdiff_t live = 0;
+
+    T* allocate(size_t n) {
+        live += n;
+        return std::allocator<T>::allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        live -= n;
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+TEST(TestSmallTrivialVector, InsertThrows) {
+    using Alloc = LiveAllocator<int>;
+    {
+        Attractadore::SmallTrivialVector<int, Alloc> vec = {1, 2, 3};
+        auto values = std::views::iota(0, 100) |
+            std::views::transform([] (int i) {
+                if (i == 50) {
+                    throw std::runtime_error{"value"};
+                }
+                return i;
+            });
+        EXPECT_THROW(vec.insert(vec.begin() + 1, values), std::runtime_error);
+        EXPECT_TRUE(vec.data_is_inlined());
+        EXPECT_TRUE(std::ranges::equal(vec, std::array{1, 2, 3}));
+        EXPECT_EQ(Alloc::live, 0);
+    }
+    EXPECT_EQ(Alloc::live, 0);
+}
+
+TEST(TestSmallTrivialVector, Resize) {
+    Attractadore::SmallTrivialVector<char> vec(3, 'a');
+    vec.resize(40, 'b');
+    EXPECT_EQ(std::ranges::count(vec, 'a'), 3);
+    EXPECT_EQ(std::ranges::count(vec, 'b'), 37);
+    vec.assign(5, 'c');
+    EXPECT_TRUE(std::ranges::equal(vec, std::string_view{"ccccc"}));
+    vec.assign(std::string_view{"a string longer than the inline buffer"});
+    EXPECT_EQ(std::string_view(vec.data(), vec.size()), "a string longer than the inline buffer");
+    EXPECT_THROW(vec.at(100), std::out_of_range);
+    EXPECT_THROW(vec.reserve(vec.max_size() + size_t(1)), std::length_error);
+}
+
+TEST(TestSmallTrivialVector, CopyMoveSwap) {
+    using Vec = Attractadore::SmallTrivialVector<char>;
+    Vec small(std::string_view{"small"});
+    Vec large(std::string_view{"large enough to live on the heap"});
+    Vec small_copy = small;
+    Vec large_copy = large;
+    EXPECT_EQ(small_copy, small);
+    EXPECT_EQ(large_copy, large);
+    EXPECT_LT(large, small);
+
+    Vec moved = std::move(large_copy);
+    EXPECT_EQ(moved, large);
+    EXPECT_TRUE(large_copy.empty());
+    large_copy = std::move(small_copy);
+    EXPECT_EQ(large_copy, small);
+
+    swap(small_copy, moved);
+    EXPECT_EQ(small_copy, large);
+    EXPECT_TRUE(moved.empty());
+    swap(small_copy, large_copy);
+    EXPECT_EQ(small_copy, small);
+    EXPECT_EQ(large_copy, large);
+
+    small_copy = large;
+    large_copy = small;
+    EXPECT_EQ(small_copy, large);
+    EXPECT_EQ(large_copy, small);
+}
+
+TEST(TestSmallTrivialVector, Compact) {
+    Attractadore::CompactSmallTrivialVector<uint8_t> vec;
+    std::vector<uint8_t> ref;
+    for (int i = 0; i < 100; i++) {
+        vec.push_back(i);
+        ref.push_back(i);
+    }
+    EXPECT_TRUE(std::ranges::equal(vec, ref));
+    EXPECT_EQ(vec.max_size(), (uint32_t(1) << 24) - 1);
+}
+
+TEST(TestSmallTrivialVector, NoInlineStorage) {
+    using Big = std::array<char, 32>;
+    using Vec = Attractadore::SmallTrivialVector<Big>;
+    static_assert(Vec::max_inline_size() == 0);
+    Vec vec;
+    EXPECT_TRUE(vec.empty());
+    EXPECT_FALSE(vec.data_is_inlined());
+    EXPECT_EQ(vec.capacity(), 0);
+    vec.shrink_to_fit();
+    vec.push_back(Big{'a'});
+    vec.push_back(Big{'b'});
+    EXPECT_FALSE(vec.data_is_inlined());
+    EXPECT_EQ(vec.back()[0], 'b');
+
+    Vec moved = std::move(vec);
+    EXPECT_TRUE(vec.empty());
+    EXPECT_EQ(moved.size(), 2);
+    vec = moved;
+    swap(vec, moved);
+    EXPECT_EQ(vec, moved);
+    moved.clear();
+    moved.shrink_to_fit();
+    EXPECT_EQ(moved.capacity(), 0);
+    EXPECT_FALSE(moved.data_is_inlined());
+}
+
+namespace {
+struct DefaultPoint {
+    int x = 1;
+    int y = 2;
+};
+
+struct NoDefault {
+    int value;
+    constexpr NoDefault(int value): value(value) {}
+};
+}
+
+TEST(TestTriviallyCopyable, DefaultMemberInitializers) {
+    static_assert(not std::is_trivial_v<DefaultPoint>);
+    InlineTrivialVector<DefaultPoint, 2> vec(3);
+    EXPECT_TRUE(std::ranges::all_of(vec, [] (auto p) { return p.x == 1 and p.y == 2; }));
+    vec.front() = {5, 6};
+    vec.resize(10);
+    EXPECT_EQ(vec.front().x, 5);
+    EXPECT_TRUE(std::ranges::all_of(vec | std::views::drop(1),
+        [] (auto p) { return p.x == 1 and p.y == 2; }));
+    vec.truncate(1);
+    vec.resize(4, {7, 8});
+    EXPECT_EQ(vec.back().y, 8);
+
+    Attractadore::SmallTrivialVector<DefaultPoint> small(2);
+    EXPECT_EQ(small.back().y, 2);
+}
+
+TEST(TestTriviallyCopyable, NoDefaultConstructor) {
+    static_assert(not std::constructible_from<InlineTrivialVector<NoDefault, 4>, size_t>);
+    InlineTrivialVector<NoDefault, 4> vec1 = {1, 2};
+    InlineTrivialVector<NoDefault, 4> vec2 = {3, 4, 5};
+    vec1.swap(vec2);
+    EXPECT_EQ(vec1.size(), 3);
+    EXPECT_EQ(vec1[2].value, 5);
+    EXPECT_EQ(vec2[1].value, 2);
+    for (int i = 0; i < 10; i++) {
+        vec2.push_back(i);
+    }
+    vec1.swap(vec2);
+    EXPECT_EQ(vec1.size(), 12);
+    EXPECT_EQ(vec2.size(), 3);
+    auto moved = std::move(vec2);
+    EXPECT_EQ(moved[0].value, 3);
+}
+
+namespace {
+// Checks every position and every size up to a few vectors' worth, so that
+// both the full vector loop and the tail are exercised
+template<typename T>
+void check_find() {
+    for (size_t size = 0; size < 200; size++) {
+        TrivialVector<T> vec(size);
+        std::iota(vec.begin(), vec.end(), T(1));
+        EXPECT_FALSE(vec.contains(T(0)));
+        EXPECT_EQ(vec.find(T(0)), vec.end());
+        EXPECT_EQ(vec.index_of(T(0)), vec.npos);
+        EXPECT_EQ(vec.count(T(0)), 0);
+        for (size_t i = 0; i < size; i++) {
+            auto value = vec[i];
+            ASSERT_EQ(vec.index_of(value), i) << size;
+            ASSERT_EQ(vec.find(value), vec.begin() + i);
+            ASSERT_TRUE(vec.contains(value));
+            ASSERT_EQ(vec.count(value), 1);
+        }
+        for (size_t i = 0; i < size; i += 3) {
+            vec[i] = T(0);
+        }
+        ASSERT_EQ(vec.count(T(0)), std::ranges::count(vec, T(0))) << size;
+        ASSERT_EQ(vec.find(T(0)), std::ranges::find(vec, T(0)));
+    }
+}
+}
+
+TEST(TestFind, Integers) {
+    check_find<int8_t>();
+    check_find<uint16_t>();
+    check_find<uint32_t>();
+    check_find<int64_t>();
+    check_find<uint64_t>();
+}
+
+TEST(TestFind, FloatingPoint) {
+    check_find<float>();
+    check_find<double>();
+
+    TrivialVector<double> vec = {1.0, NAN, -0.0, 2.0};
+    EXPECT_FALSE(vec.contains(NAN));
+    EXPECT_EQ(vec.index_of(0.0), 2);
+    EXPECT_EQ(vec.count(0.0), 1);
+}
+
+TEST(TestFind, HighBits) {
+    // Only one half of each 64 bit element matches
+    TrivialVector<uint64_t> vec = {0x1'0000'0007, 0x7'0000'0001, 7};
+    EXPECT_EQ(vec.index_of(7), 2);
+    EXPECT_EQ(vec.count(uint64_t(0x1'0000'0007)), 1);
+}
+
+TEST(TestFind, Inline) {
+    InlineTrivialVector<uint32_t, 16> vec = {5, 3, 9, 3};
+    EXPECT_EQ(vec.index_of(3), 1);
+    EXPECT_EQ(vec.count(3), 2);
+    EXPECT_FALSE(vec.contains(4));
+    static_assert([] {
+        using namespace Attractadore::TrivialVectorNameSpace;
+        int data[] = {1, 2, 3, 2};
+        return find_index(data, 4, 3) == 2 and count_equal(data, 4, 2) == 2;
+    }());
+
+    Attractadore::SmallTrivialVector<uint16_t> small = {4, 8, 15, 16, 23, 42};
+    EXPECT_EQ(small.index_of(42), 5);
+    EXPECT_EQ(*small.find(15), 15);
+    EXPECT_TRUE(small.contains(23));
+    EXPECT_EQ(small.count(7), 0);
+}
+
+TEST(TestFind, NonArithmetic) {
+    struct Pair {
+        int x, y;
+        bool operator==(const Pair&) const = default;
+    };
+    TrivialVector<Pair> vec = {{1, 2}, {3, 4}, {1, 2}};
+    EXPECT_EQ(vec.index_of({3, 4}), 1);
+    EXPECT_EQ(vec.count({1, 2}), 2);
+}
+
+TEST(TestHash, Bytes) {
+    using Attractadore::TrivialVectorNameSpace::hash_bytes;
+    // Every length and every single byte change gives a different hash
+    std::array<unsigned char, 200> buf{};
+    std::unordered_set<uint64_t> hashes;
+    for (size_t size = 0; size <= buf.size(); size++) {
+        EXPECT_TRUE(hashes.insert(hash_bytes(buf.data(), size)).second) << size;
+        EXPECT_EQ(hash_bytes(buf.data(), size), hash_bytes(buf.data(), size));
+    }
+    for (size_t i = 0; i < buf.size(); i++) {
+        buf[i] = 1;
+        EXPECT_TRUE(hashes.insert(hash_bytes(buf.data(), buf.size())).second) << i;
+        buf[i] = 0;
+    }
+    EXPECT_NE(hash_bytes(buf.data(), 10, 1), hash_bytes(buf.data(), 10, 2));
+}
+
+TEST(TestHash, Member) {
+    TrivialVector<uint32_t> vec = {1, 2, 3};
+    InlineTrivialVector<uint32_t, 4> inl = {1, 2, 3};
+    Attractadore::SmallTrivialVector<uint32_t> small = {1, 2, 3};
+    EXPECT_EQ(vec.hash(), inl.hash());
+    EXPECT_EQ(vec.hash(), small.hash());
+    EXPECT_EQ(vec.hash(), std::hash<decltype(vec)>{}(vec));
+    EXPECT_EQ(inl.hash(), std::hash<decltype(inl)>{}(inl));
+    EXPECT_EQ(small.hash(), std::hash<decltype(small)>{}(small));
+    vec.push_back(0);
+    EXPECT_NE(vec.hash(), inl.hash());
+}
+
+TEST(TestHash, ElementWise) {
+    // Equal vectors of floats hash equal even though their bytes differ
+    TrivialVector<double> vec1 = {1.0, 0.0};
+    TrivialVector<double> vec2 = {1.0, -0.0};
+    EXPECT_EQ(vec1, vec2);
+    EXPECT_EQ(vec1.hash(), vec2.hash());
+
+    struct NoHash { int x; };
+    static_assert(not std::is_default_constructible_v<std::hash<TrivialVector<NoHash>>>);
+}
+
+TEST(TestHash, UnorderedSet) {
+    std::unordered_set<TrivialVector<uint8_t>> set;
+    for (uint8_t i = 0; i < 100; i++) {
+        set.insert(TrivialVector<uint8_t>(i, i));
+    }
+    EXPECT_EQ(set.size(), 100);
+    EXPECT_TRUE(set.contains(TrivialVector<uint8_t>(50, 50)));
+    EXPECT_FALSE(set.contains(TrivialVector<uint8_t>(50, 51)));
+}
+
+TEST(TestHash, Frozen) {
+    using Key = Attractadore::FrozenVector<InlineTrivialVector<uint32_t, 4>>;
+    std::unordered_map<Key, int> map;
+    map.emplace(Key{{1, 2, 3}}, 1);
+    map.emplace(Key{{1, 2, 3, 4, 5}}, 2);
+    EXPECT_EQ(map.at(Key{{1, 2, 3}}), 1);
+    EXPECT_EQ(map.at(Key{{1, 2, 3, 4, 5}}), 2);
+    EXPECT_FALSE(map.contains(Key{{1, 2}}));
+
+    Key key{{7, 8}};
+    EXPECT_EQ(key.hash(), key->hash());
+    EXPECT_EQ(key.get().size(), 2);
+    EXPECT_EQ((*key)[1], 8);
+    static_assert(Attractadore::is_trivially_relocatable_v<Key>);
+}